@@ -0,0 +1,603 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional> // for std::hash
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <bit> // for std::bit_width, std::bit_floor
+#include <cstdint>
+#include <chrono>
+#include <random>
+
+#define HASH_TABLE_3_NO_MAIN
+#include "../Separate Chaining/hash_table_3.cpp"
+
+/**
+ * @brief Epoch-based memory reclamation shared by every lock-free table in this file.
+ *
+ * A thread pins the current global epoch for the length of one operation (EpochGuard). A node that
+ * has been unlinked is retired, tagged with the global epoch at that moment, and freed only once
+ * the global epoch is two ahead of the tag. The global epoch only advances when every pinned
+ * thread has seen its current value, so by then no thread can still hold a pointer to the node.
+ *
+ * Readers pay one store and one fence per operation, however many nodes they walk. Hazard
+ * pointers would need a fence for every node. Each thread claims one of MaxThreads slots on first
+ * use and gives it back when it exits. The next thread to claim the slot inherits any garbage
+ * still waiting in it.
+ */
+class EpochDomain {
+private:
+    struct Retired {
+        void* pointer;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    struct alignas(64) Slot {
+        // (epoch << 1) | 1 while the owner is inside an operation, 0 otherwise
+        std::atomic<uint64_t> state{0};
+        std::atomic<bool> claimed{false};
+        // Only touched by the owning thread
+        std::vector<Retired> retired;
+    };
+
+    static constexpr size_t MaxThreads = 256;
+
+    // Retirements between two attempts to advance the epoch and free garbage
+    static constexpr size_t ReclaimEvery = 64;
+
+    std::atomic<uint64_t> globalEpoch{1};
+    Slot slots[MaxThreads];
+
+    // Returns the slot back to the pool when its thread exits
+    struct SlotOwner {
+        EpochDomain* domain;
+        Slot* slot = nullptr;
+
+        ~SlotOwner() {
+            if (slot != nullptr) {
+                slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    Slot& mySlot() {
+        thread_local SlotOwner owner{this};
+        if (owner.slot == nullptr) {
+            for (Slot& slot : slots) {
+                bool expected = false;
+                if (!slot.claimed.load(std::memory_order_relaxed) &&
+                    slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    owner.slot = &slot;
+                    break;
+                }
+            }
+            if (owner.slot == nullptr) {
+                std::cerr << "EpochDomain: more than " << MaxThreads << " threads" << std::endl;
+                std::abort();
+            }
+        }
+        return *owner.slot;
+    }
+
+    // Advance the global epoch if every pinned thread is in it
+    void tryAdvance() {
+        uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+        for (Slot& slot : slots) {
+            uint64_t state = slot.state.load(std::memory_order_seq_cst);
+            if ((state & 1) && (state >> 1) != epoch) {
+                return;
+            }
+        }
+        globalEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    }
+
+    static void freeOlderThan(std::vector<Retired>& retired, uint64_t safeEpoch) {
+        size_t kept = 0;
+        for (Retired& item : retired) {
+            if (item.epoch + 2 <= safeEpoch) {
+                item.deleter(item.pointer);
+            } else {
+                retired[kept++] = item;
+            }
+        }
+        retired.resize(kept);
+    }
+
+public:
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    ~EpochDomain() {
+        for (Slot& slot : slots) {
+            for (Retired& item : slot.retired) {
+                item.deleter(item.pointer);
+            }
+        }
+    }
+
+    void pin() {
+        Slot& slot = mySlot();
+        // The seq_cst store orders the announcement before every load of the operation
+        slot.state.store((globalEpoch.load(std::memory_order_seq_cst) << 1) | 1, std::memory_order_seq_cst);
+    }
+
+    void unpin() {
+        mySlot().state.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @brief Free 'pointer' with 'deleter' once no pinned thread can still reach it.
+     * The caller has already unlinked it and is pinned.
+     */
+    void retire(void* pointer, void (*deleter)(void*)) {
+        Slot& slot = mySlot();
+        slot.retired.push_back({pointer, deleter, globalEpoch.load(std::memory_order_seq_cst)});
+        if (slot.retired.size() % ReclaimEvery == 0) {
+            tryAdvance();
+            freeOlderThan(slot.retired, globalEpoch.load(std::memory_order_acquire));
+        }
+    }
+};
+
+// Pins the epoch for one operation
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::instance().pin(); }
+    ~EpochGuard() { EpochDomain::instance().unpin(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+/**
+ * @brief A lock-free hash table: Shalev and Shavit's split-ordered list.
+ *
+ * Every element sits in one sorted lock-free linked list (Michael's algorithm: a node is deleted by
+ * first marking the low bit of its next pointer, then unlinking it). The list is sorted by the
+ * bit-reversed hash, so the elements of bucket b, for any power-of-two bucket count, form one
+ * contiguous run. Each bucket starts with a sentinel node whose key is the reversed bucket index.
+ *
+ * Resizing therefore moves nothing: doubling the bucket count is one compare-and-swap. A new
+ * bucket is initialized lazily, by the first operation that needs it, by inserting its sentinel
+ * starting from its parent bucket (the index with the top bit cleared). Readers never wait on a
+ * resize and never take a lock. search() just walks the list and does not help unlink nodes.
+ *
+ * The bucket array is a set of segments of doubling size, allocated on first use, so growing it
+ * never copies or frees what readers are looking at. The sentinels live inside the segments rather
+ * than behind a pointer, so a lookup's dependent misses are the bucket and then the elements.
+ * Exactly one thread links each sentinel into the list. A thread that finds a sentinel still being
+ * linked starts from the parent bucket's sentinel, whose run of the list covers this bucket too,
+ * so it never waits. Removed nodes are handed to the EpochDomain.
+ *
+ * insert() does not overwrite an existing key (it returns false), as in the original algorithm;
+ * replace a value with remove() then insert().
+ *
+ * @tparam K Type of keys.
+ * @tparam V Type of values.
+ */
+template <typename K, typename V>
+class SplitOrderedHashTable {
+private:
+    struct Node {
+        // Bit-reversed hash: odd for elements, even for bucket sentinels
+        uint64_t soKey;
+        // Low bit set once this node is logically deleted
+        std::atomic<Node*> next;
+
+        Node() : soKey(0), next(nullptr) {}
+        explicit Node(uint64_t key) : soKey(key), next(nullptr) {}
+    };
+
+    struct DataNode : Node {
+        K key;
+        V value;
+
+        DataNode(uint64_t so, const K& k, const V& v) : Node(so), key(k), value(v) {}
+    };
+
+    enum : uint8_t { Unlinked, Linking, Linked };
+
+    struct Bucket {
+        Node sentinel;
+        std::atomic<uint8_t> state{Unlinked};
+    };
+
+    // Segment s holds buckets [2^(s - 1), 2^s), segment 0 holds bucket 0
+    static constexpr int MaxSegments = 64;
+    std::atomic<Bucket*> segments[MaxSegments];
+
+    // Number of buckets in use, a power of two
+    std::atomic<size_t> bucketCount;
+
+    // Number of elements
+    std::atomic<size_t> numElements;
+
+    // Average elements per bucket before the bucket count doubles
+    double maxLoadFactor;
+
+    static bool isMarked(Node* node) {
+        return reinterpret_cast<uintptr_t>(node) & 1;
+    }
+
+    static Node* marked(Node* node) {
+        return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(node) | 1);
+    }
+
+    static Node* unmarked(Node* node) {
+        return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(node) & ~uintptr_t{1});
+    }
+
+    static uint64_t reverseBits(uint64_t x) {
+        x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        return __builtin_bswap64(x);
+    }
+
+    /**
+     * @brief Hash Table function: std::hash finished with the splitmix64 mixer. The top bit is
+     * dropped so that it can be set to mark element keys.
+     */
+    static uint64_t hashFunction(const K& key) {
+        uint64_t hash = static_cast<uint64_t>(std::hash<K>{}(key));
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        return (hash ^ (hash >> 31)) & ~(uint64_t{1} << 63);
+    }
+
+    static uint64_t elementKey(uint64_t hash) {
+        return reverseBits(hash | (uint64_t{1} << 63));
+    }
+
+    static uint64_t sentinelKey(size_t bucket) {
+        return reverseBits(bucket);
+    }
+
+    static void deleteDataNode(void* node) {
+        delete static_cast<DataNode*>(node);
+    }
+
+    Bucket& bucketAt(size_t bucket) {
+        int segment = std::bit_width(bucket);
+        size_t first = bucket == 0 ? 0 : std::bit_floor(bucket);
+        Bucket* array = segments[segment].load(std::memory_order_acquire);
+        if (array == nullptr) {
+            size_t length = segment == 0 ? 1 : size_t{1} << (segment - 1);
+            Bucket* fresh = new Bucket[length];
+            for (size_t i = 0; i < length; i++) {
+                fresh[i].sentinel.soKey = sentinelKey(first + i);
+            }
+            if (segments[segment].compare_exchange_strong(array, fresh, std::memory_order_acq_rel)) {
+                array = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        return array[bucket - first];
+    }
+
+    /**
+     * @brief Michael's search: find the first node at or after 'start' whose soKey is not below
+     * 'soKey' and that is not an element with that soKey and a different key. Marked nodes met on
+     * the way are unlinked and retired.
+     *
+     * @param key The element key to match, or nullptr to match a sentinel by soKey alone.
+     * @return The link that points at the node found, and the node (nullptr at the end of the list).
+     */
+    std::pair<std::atomic<Node*>*, Node*> find(Node* start, uint64_t soKey, const K* key) {
+    retry:
+        std::atomic<Node*>* prev = &start->next;
+        Node* cur = prev->load(std::memory_order_acquire);
+        while (true) {
+            if (cur == nullptr) {
+                return {prev, nullptr};
+            }
+            Node* next = cur->next.load(std::memory_order_acquire);
+            if (isMarked(next)) {
+                Node* expected = cur;
+                if (!prev->compare_exchange_strong(expected, unmarked(next), std::memory_order_acq_rel)) {
+                    goto retry;
+                }
+                EpochDomain::instance().retire(cur, &deleteDataNode);
+                cur = unmarked(next);
+                continue;
+            }
+            if (cur->soKey > soKey ||
+                (cur->soKey == soKey && (key == nullptr || static_cast<DataNode*>(cur)->key == *key))) {
+                return {prev, cur};
+            }
+            prev = &cur->next;
+            cur = next;
+        }
+    }
+
+    static bool matches(Node* node, uint64_t soKey, const K* key) {
+        return node != nullptr && node->soKey == soKey &&
+               (key == nullptr || static_cast<DataNode*>(node)->key == *key);
+    }
+
+    /**
+     * @brief Link 'node' into the list after 'start', unless a matching node is already there.
+     * @return The node now in the list: 'node', or the one that was already there.
+     */
+    Node* insertAfter(Node* start, Node* node, const K* key) {
+        while (true) {
+            auto [prev, cur] = find(start, node->soKey, key);
+            if (matches(cur, node->soKey, key)) {
+                return cur;
+            }
+            node->next.store(cur, std::memory_order_relaxed);
+            if (prev->compare_exchange_strong(cur, node, std::memory_order_acq_rel)) {
+                return node;
+            }
+        }
+    }
+
+    /**
+     * @brief A linked sentinel at or before the run of 'bucket': its own, linking it (and its
+     * parents) first if no one has yet, or its parent's while another thread is linking it.
+     */
+    Node* sentinelFor(size_t bucket) {
+        Bucket& entry = bucketAt(bucket);
+        uint8_t state = entry.state.load(std::memory_order_acquire);
+        if (state == Linked) {
+            return &entry.sentinel;
+        }
+        Node* parent = sentinelFor(bucket & ~std::bit_floor(bucket));
+        if (state == Unlinked && entry.state.compare_exchange_strong(state, Linking, std::memory_order_acquire)) {
+            // Only this thread links this sentinel, so insertAfter cannot find it already there
+            insertAfter(parent, &entry.sentinel, nullptr);
+            entry.state.store(Linked, std::memory_order_release);
+            return &entry.sentinel;
+        }
+        return parent;
+    }
+
+    Node* startFor(uint64_t hash) {
+        return sentinelFor(hash & (bucketCount.load(std::memory_order_acquire) - 1));
+    }
+
+public:
+    /**
+     * @brief Construct an empty table.
+     *
+     * @param initialBuckets The initial number of buckets, rounded up to a power of two.
+     * @param loadFactorThreshold Average elements per bucket before the bucket count doubles. Default is 1.
+     */
+    explicit SplitOrderedHashTable(size_t initialBuckets = 16, double loadFactorThreshold = 1.0)
+            : bucketCount(std::bit_ceil(std::max<size_t>(initialBuckets, 1))), numElements(0),
+              maxLoadFactor(loadFactorThreshold) {
+        for (auto& segment : segments) {
+            segment.store(nullptr, std::memory_order_relaxed);
+        }
+        bucketAt(0).state.store(Linked, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Destroy the table. No other thread may be using it. Nodes already retired are
+     * freed by the EpochDomain, everything still linked is freed here.
+     */
+    ~SplitOrderedHashTable() {
+        Node* node = &bucketAt(0).sentinel;
+        while (node != nullptr) {
+            Node* next = unmarked(node->next.load(std::memory_order_relaxed));
+            if (node->soKey & 1) {
+                delete static_cast<DataNode*>(node);
+            }
+            node = next;
+        }
+        for (auto& segment : segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+    }
+
+    SplitOrderedHashTable(const SplitOrderedHashTable&) = delete;
+    SplitOrderedHashTable& operator=(const SplitOrderedHashTable&) = delete;
+
+    /**
+     * @brief Insert a key-value pair if the key is not present yet.
+     *
+     * @return true If the pair was inserted, false if the key was already there.
+     */
+    bool insert(const K& key, const V& value) {
+        EpochGuard guard;
+        uint64_t hash = hashFunction(key);
+        DataNode* node = new DataNode(elementKey(hash), key, value);
+        if (insertAfter(startFor(hash), node, &key) != node) {
+            delete node;
+            return false;
+        }
+        size_t buckets = bucketCount.load(std::memory_order_relaxed);
+        if (numElements.fetch_add(1, std::memory_order_relaxed) + 1 > buckets * maxLoadFactor) {
+            // Losing this race only means another thread doubled it already
+            bucketCount.compare_exchange_strong(buckets, buckets * 2, std::memory_order_acq_rel);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Remove a key.
+     *
+     * @return true If this call removed the key.
+     */
+    bool remove(const K& key) {
+        EpochGuard guard;
+        uint64_t hash = hashFunction(key);
+        uint64_t soKey = elementKey(hash);
+        Node* start = startFor(hash);
+        while (true) {
+            auto [prev, cur] = find(start, soKey, &key);
+            if (!matches(cur, soKey, &key)) {
+                return false;
+            }
+            Node* next = cur->next.load(std::memory_order_acquire);
+            if (isMarked(next)) {
+                continue;
+            }
+            // Marking the next pointer is the linearization point; unlinking can be left to anyone
+            if (!cur->next.compare_exchange_strong(next, marked(next), std::memory_order_acq_rel)) {
+                continue;
+            }
+            numElements.fetch_sub(1, std::memory_order_relaxed);
+            Node* expected = cur;
+            if (prev->compare_exchange_strong(expected, next, std::memory_order_acq_rel)) {
+                EpochDomain::instance().retire(cur, &deleteDataNode);
+            } else {
+                find(start, soKey, &key);
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Search for a key without writing to shared memory beyond the epoch announcement.
+     *
+     * @return A copy of the value if found, std::nullopt otherwise. The node may be retired as
+     * soon as the epoch is unpinned, so the value is copied out before that.
+     */
+    std::optional<V> search(const K& key) {
+        EpochGuard guard;
+        uint64_t hash = hashFunction(key);
+        uint64_t soKey = elementKey(hash);
+        Node* cur = unmarked(startFor(hash)->next.load(std::memory_order_acquire));
+        while (cur != nullptr && cur->soKey <= soKey) {
+            Node* next = cur->next.load(std::memory_order_acquire);
+            if (cur->soKey == soKey && !isMarked(next) && static_cast<DataNode*>(cur)->key == key) {
+                return static_cast<DataNode*>(cur)->value;
+            }
+            cur = unmarked(next);
+        }
+        return std::nullopt;
+    }
+
+    bool contains(const K& key) {
+        return search(key).has_value();
+    }
+
+    size_t size() const {
+        return numElements.load(std::memory_order_relaxed);
+    }
+};
+
+// hash_table_3's single-threaded HashTable behind one external mutex: the baseline
+class MutexHashTable {
+private:
+    std::mutex lock;
+    HashTable<uint64_t, uint64_t> table;
+
+public:
+    bool insert(uint64_t key, uint64_t value) {
+        std::lock_guard guard(lock);
+        bool inserted = !table.contains(key);
+        table.insert(key, value);
+        return inserted;
+    }
+
+    bool remove(uint64_t key) {
+        std::lock_guard guard(lock);
+        return table.remove(key);
+    }
+
+    std::optional<uint64_t> search(uint64_t key) {
+        std::lock_guard guard(lock);
+        uint64_t* value = table.search(key);
+        return value == nullptr ? std::nullopt : std::optional<uint64_t>(*value);
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Runs totalOps uniformly random operations split over numThreads threads: readPercent%
+ * searches, the rest half removes and half inserts, against a table holding half the key space.
+ */
+template <typename Table>
+void benchmarkReadMostly(const char* name, Table& table, uint64_t numKeys, size_t totalOps, int numThreads,
+                         int readPercent) {
+    std::atomic<uint64_t> found{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rng(2000 + t);
+            uint64_t hits = 0;
+            for (size_t i = t; i < totalOps; i += numThreads) {
+                uint64_t draw = rng();
+                uint64_t key = draw % numKeys;
+                int dice = static_cast<int>((draw >> 40) % 100);
+                if (dice < readPercent) {
+                    hits += table.search(key).has_value();
+                } else if (dice & 1) {
+                    table.remove(key);
+                } else {
+                    table.insert(key, i);
+                }
+            }
+            found.fetch_add(hits, std::memory_order_relaxed);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = secondsSince(start);
+    std::cout << "    " << name << totalOps / seconds / 1e6 << " Mops/s" << (found == 0 ? " " : "") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Create a hash table with integer keys and string values
+    SplitOrderedHashTable<int, std::string> hashTable;
+
+    // Test insertion
+    hashTable.insert(1, "One");
+    hashTable.insert(2, "Two");
+    hashTable.insert(3, "Three");
+    hashTable.insert(17, "Seventeen");
+    std::cout << "Insert key 3 again: " << (hashTable.insert(3, "Drei") ? "inserted" : "already present") << "\n";
+
+    // Test search
+    int searchKey = 3;
+    if (std::optional<std::string> value = hashTable.search(searchKey)) {
+        std::cout << "Found key " << searchKey << " with value: " << *value << "\n";
+    } else {
+        std::cout << "Key " << searchKey << " not found.\n";
+    }
+
+    // Test removal
+    int removeKey = 2;
+    std::cout << "Key " << removeKey << (hashTable.remove(removeKey) ? " removed successfully.\n" : " not found.\n");
+
+    // Test contains
+    int checkKey = 17;
+    std::cout << "Hash Table Table contains key " << checkKey << ": "
+              << (hashTable.contains(checkKey) ? "Yes" : "No") << "\n";
+    std::cout << "Current size: " << hashTable.size() << "\n";
+
+    // Pass "full" for 10x the operations
+    bool full = argc > 1 && std::string(argv[1]) == "full";
+    uint64_t numKeys = 2'000'000;
+    size_t totalOps = full ? 100'000'000 : 10'000'000;
+    std::cout << "\nThreads on this machine: " << std::thread::hardware_concurrency() << std::endl;
+
+    SplitOrderedHashTable<uint64_t, uint64_t> lockFree;
+    MutexHashTable locked;
+    for (uint64_t key = 0; key < numKeys; key += 2) {
+        lockFree.insert(key, key);
+        locked.insert(key, key);
+    }
+    std::cout << "Uniform keys over " << numKeys << ", half present, 99% searches, " << totalOps
+              << " operations" << std::endl;
+    for (int numThreads : {1, 2, 4, 8, 16, 32, 64}) {
+        std::cout << "  " << numThreads << " threads" << std::endl;
+        benchmarkReadMostly("split-ordered, lock-free: ", lockFree, numKeys, totalOps, numThreads, 99);
+        benchmarkReadMostly("hash_table_3 + mutex:     ", locked, numKeys, totalOps, numThreads, 99);
+    }
+
+    return 0;
+}
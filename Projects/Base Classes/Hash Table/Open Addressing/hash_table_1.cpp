@@ -1,16 +1,42 @@
 #include <iostream>
 #include <vector>
-#include <optional>     // For std::optional
+#include <string>
 #include <utility>      // For std::pair
 #include <functional>   // For std::hash
-#include <stdexcept>    // For exceptions
-// TODO: learn open addressing implementation
+#include <memory>       // For std::allocator, std::construct_at
+#include <algorithm>
+#include <bit>          // For std::countr_zero, std::bit_ceil
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /**
- * @brief HashTable class using Open Addressing with Linear Probing.
+ * @brief HashTable class using Open Addressing, laid out like a Swiss table.
  *
  * This class provides a generic Hash Table Table implementation that stores key-value pairs.
- * It uses open addressing with linear probing for collision resolution.
+ * Collisions are resolved by open addressing, but instead of looking at one slot at a time the
+ * table probes 16 slots at once:
+ *
+ * - Next to the key/value slots there is a dense array of 1-byte control bytes, one per slot.
+ *   A full slot's control byte holds 7 bits of its key's hash (H2); free slots hold EMPTY or
+ *   DELETED, which both have the sign bit set.
+ * - The slots are split into groups of 16. The rest of the hash (H1) picks the first group, and
+ *   a probe loads that group's 16 control bytes into one SSE2 register, compares all of them
+ *   with H2 in a single instruction and turns the result into a bitmask with movemask. Only the
+ *   slots whose bit is set (on average far less than one wrong one per group) have their keys
+ *   compared.
+ * - A group that still has an EMPTY byte ends the probe: the key would have been placed there.
+ *   Otherwise the probe moves on to the next group (triangular steps, which visit every group
+ *   when the group count is a power of two).
+ *
+ * The control bytes of a whole group share one cache line, so most lookups touch exactly one
+ * line of control bytes and one slot. Compared with a std::optional<std::pair<K, V>> and a
+ * separate state enum per slot, the bookkeeping is 1 byte per slot.
  *
  * @tparam K Type of keys.
  * @tparam V Type of values.
@@ -19,50 +45,117 @@
 template <typename K, typename V, typename Hash = std::hash<K>>
 class HashTable {
 private:
-    /**
-     * @brief Enum to represent the state of each slot in the hash table.
-     */
-    enum class SlotState { EMPTY, OCCUPIED, DELETED };
+    using Pair = std::pair<K, V>;
+
+    // Control byte values; a full slot holds its H2 in [0, 127]
+    static constexpr int8_t EMPTY   = -128;
+    static constexpr int8_t DELETED = -2;
+
+    // Slots probed together, one SSE2 register of control bytes
+    static constexpr size_t GroupWidth = 16;
 
     /**
-     * @brief Struct to represent each slot in the hash table.
+     * @brief The 16 control bytes of one group, with bitmask queries (bit i = slot i of the group).
      */
-    struct Slot {
-        std::optional<std::pair<K, V>> data; // Holds the key-value pair if occupied
-        SlotState state;                     // Current state of the slot
+    struct Group {
+#if defined(__SSE2__)
+        __m128i ctrl;
+
+        explicit Group(const int8_t* pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+        // Slots whose control byte equals 'h2'
+        uint32_t match(int8_t h2) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+        }
 
-        // Constructor
-        Slot() : data(std::nullopt), state(SlotState::EMPTY) {}
+        uint32_t matchEmpty() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(EMPTY), ctrl)));
+        }
+
+        // EMPTY or DELETED: the sign bit is all movemask looks at
+        uint32_t matchFree() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+        }
+#else
+        const int8_t* ctrl;
+
+        explicit Group(const int8_t* pos) : ctrl(pos) {}
+
+        uint32_t match(int8_t h2) const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GroupWidth; i++) {
+                mask |= uint32_t(ctrl[i] == h2) << i;
+            }
+            return mask;
+        }
+
+        uint32_t matchEmpty() const {
+            return match(EMPTY);
+        }
+
+        uint32_t matchFree() const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GroupWidth; i++) {
+                mask |= uint32_t(ctrl[i] < 0) << i;
+            }
+            return mask;
+        }
+#endif
     };
 
-    std::vector<Slot> table;    // Dynamic array to store slots
+    std::vector<int8_t> ctrl;   // One control byte per slot
+    Pair* slots;                // Key-value slots, constructed only while full
     size_t numElements;         // Number of elements currently in the table
-    size_t capacity;            // Current capacity of the table (number of slots)
+    size_t numDeleted;          // Number of DELETED control bytes (tombstones)
+    size_t capacity;            // Current capacity of the table (number of slots, a power of two >= 16)
     double maxLoadFactor;       // Maximum allowed load factor before resizing
     Hash hashFunc;              // Hash Table function object
+    std::allocator<Pair> alloc; // Raw storage for 'slots'
 
     /**
-     * @brief Computes the hash index for a given key.
+     * @brief Computes the full hash of a key: hashFunc finalized with a mixer.
+     *
+     * std::hash of an integer is the integer itself, so without the mixer sequential keys would
+     * all share H2 and fill consecutive groups. The low 7 bits become H2, the rest H1.
      *
      * @param key The key to hash.
-     * @return size_t The computed index within the table.
+     * @return size_t The mixed hash.
      */
     size_t hashFunction(const K& key) const;
 
+    /**
+     * @brief Index of the slot holding 'key', or 'capacity' if it is not in the table.
+     */
+    size_t findIndex(const K& key, size_t hash) const;
+
+    /**
+     * @brief Index of the first EMPTY or DELETED slot on the probe sequence of 'hash'.
+     */
+    size_t findFreeSlot(size_t hash) const;
+
     /**
      * @brief Resizes the hash table when the load factor exceeds the threshold.
-     * Doubles the capacity and rehashes all existing key-value pairs.
+     * Doubles the capacity and rehashes all existing key-value pairs. If tombstones make up
+     * more than half of the budget, the capacity stays the same and the rehash just clears them.
      */
     void resize();
 
+    /**
+     * @brief Moves every element into fresh arrays of 'newCapacity' slots, dropping all tombstones.
+     */
+    void rehash(size_t newCapacity);
+
 public:
     /**
      * @brief Constructs an empty Hash Table Table with an initial capacity.
      *
-     * @param initialCapacity The initial number of slots. Default is 16.
-     * @param loadFactorThreshold The load factor threshold to trigger resizing. Default is 0.7.
+     * @param initialCapacity The initial number of slots, rounded up to a power of two (at least 16). Default is 16.
+     * @param loadFactorThreshold The load factor threshold to trigger resizing, at most 15/16. Default is 0.875.
      */
-    HashTable(size_t initialCapacity = 16, double loadFactorThreshold = 0.7);
+    HashTable(size_t initialCapacity = 16, double loadFactorThreshold = 0.875);
+
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
 
     /**
      * @brief Destructor to clean up resources.
@@ -81,6 +174,9 @@ public:
     /**
      * @brief Removes a key from the Hash Table Table.
      *
+     * The slot becomes EMPTY again when its group still has an EMPTY byte (no probe ever went
+     * past that group), otherwise it becomes a DELETED tombstone.
+     *
      * @param key The key to remove.
      * @return true If the key was found and removed.
      * @return false If the key was not found.
@@ -137,7 +233,662 @@ public:
     float loadFactor() const;
 };
 
-int main() {
+template <typename K, typename V, typename Hash>
+HashTable<K, V, Hash>::HashTable(size_t initialCapacity, double loadFactorThreshold)
+        : ctrl(std::bit_ceil(std::max(initialCapacity, GroupWidth)), EMPTY),
+          numElements(0), numDeleted(0), capacity(ctrl.size()),
+          maxLoadFactor(std::clamp(loadFactorThreshold, 0.1, 15.0 / 16)) {
+    slots = alloc.allocate(capacity);
+}
+
+template <typename K, typename V, typename Hash>
+HashTable<K, V, Hash>::~HashTable() {
+    clear();
+    alloc.deallocate(slots, capacity);
+}
+
+template <typename K, typename V, typename Hash>
+size_t HashTable<K, V, Hash>::hashFunction(const K& key) const {
+    // splitmix64 finalizer
+    uint64_t x = hashFunc(key);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<size_t>(x ^ (x >> 31));
+}
+
+template <typename K, typename V, typename Hash>
+size_t HashTable<K, V, Hash>::findIndex(const K& key, size_t hash) const {
+    const int8_t h2 = static_cast<int8_t>(hash & 0x7F);
+    const size_t groupMask = capacity / GroupWidth - 1;
+    size_t group = (hash >> 7) & groupMask;
+    for (size_t step = 1; ; step++) {
+        Group g(ctrl.data() + group * GroupWidth);
+        for (uint32_t candidates = g.match(h2); candidates != 0; candidates &= candidates - 1) {
+            size_t index = group * GroupWidth + std::countr_zero(candidates);
+            if (slots[index].first == key) {
+                return index;
+            }
+        }
+        if (g.matchEmpty() != 0) {
+            return capacity;
+        }
+        group = (group + step) & groupMask;
+    }
+}
+
+template <typename K, typename V, typename Hash>
+size_t HashTable<K, V, Hash>::findFreeSlot(size_t hash) const {
+    const size_t groupMask = capacity / GroupWidth - 1;
+    size_t group = (hash >> 7) & groupMask;
+    for (size_t step = 1; ; step++) {
+        uint32_t free = Group(ctrl.data() + group * GroupWidth).matchFree();
+        if (free != 0) {
+            return group * GroupWidth + std::countr_zero(free);
+        }
+        group = (group + step) & groupMask;
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::resize() {
+    bool mostlyTombstones = numDeleted * 2 > capacity * maxLoadFactor;
+    rehash(mostlyTombstones ? capacity : capacity * 2);
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::rehash(size_t newCapacity) {
+    std::vector<int8_t> oldCtrl(newCapacity, EMPTY);
+    oldCtrl.swap(ctrl);
+    Pair* oldSlots = slots;
+    size_t oldCapacity = capacity;
+
+    slots = alloc.allocate(newCapacity);
+    capacity = newCapacity;
+    numDeleted = 0;
+
+    // Keys are known to be distinct, so each one just takes the first free slot on its probe sequence
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldCtrl[i] >= 0) {
+            size_t hash = hashFunction(oldSlots[i].first);
+            size_t index = findFreeSlot(hash);
+            ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+            std::construct_at(slots + index, std::move(oldSlots[i]));
+            std::destroy_at(oldSlots + i);
+        }
+    }
+    alloc.deallocate(oldSlots, oldCapacity);
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::insert(const K& key, const V& value) {
+    size_t hash = hashFunction(key);
+    size_t index = findIndex(key, hash);
+    if (index != capacity) {
+        slots[index].second = value;
+        return;
+    }
+
+    index = findFreeSlot(hash);
+    // Reusing a tombstone costs nothing; using up an EMPTY slot counts against the load factor
+    if (ctrl[index] == EMPTY && numElements + numDeleted + 1 > capacity * maxLoadFactor) {
+        resize();
+        index = findFreeSlot(hash);
+    }
+    if (ctrl[index] == DELETED) {
+        numDeleted--;
+    }
+    ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+    std::construct_at(slots + index, key, value);
+    numElements++;
+}
+
+template <typename K, typename V, typename Hash>
+bool HashTable<K, V, Hash>::remove(const K& key) {
+    size_t index = findIndex(key, hashFunction(key));
+    if (index == capacity) {
+        return false;
+    }
+
+    std::destroy_at(slots + index);
+    if (Group(ctrl.data() + index / GroupWidth * GroupWidth).matchEmpty() != 0) {
+        ctrl[index] = EMPTY;
+    } else {
+        ctrl[index] = DELETED;
+        numDeleted++;
+    }
+    numElements--;
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+V* HashTable<K, V, Hash>::search(const K& key) {
+    size_t index = findIndex(key, hashFunction(key));
+    return index == capacity ? nullptr : &slots[index].second;
+}
+
+template <typename K, typename V, typename Hash>
+bool HashTable<K, V, Hash>::containsKey(const K& key) const {
+    return findIndex(key, hashFunction(key)) != capacity;
+}
+
+template <typename K, typename V, typename Hash>
+size_t HashTable<K, V, Hash>::getSize() const {
+    return numElements;
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::printTable() const {
+    for (size_t i = 0; i < capacity; i++) {
+        if (ctrl[i] >= 0) {
+            std::cout << "Slot " << i << ": " << slots[i].first << " -> " << slots[i].second << std::endl;
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash>
+std::vector<K> HashTable<K, V, Hash>::keys() const {
+    std::vector<K> result;
+    result.reserve(numElements);
+    for (size_t i = 0; i < capacity; i++) {
+        if (ctrl[i] >= 0) {
+            result.push_back(slots[i].first);
+        }
+    }
+    return result;
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::clear() {
+    for (size_t i = 0; i < capacity; i++) {
+        if (ctrl[i] >= 0) {
+            std::destroy_at(slots + i);
+        }
+    }
+    std::fill(ctrl.begin(), ctrl.end(), EMPTY);
+    numElements = 0;
+    numDeleted = 0;
+}
+
+template <typename K, typename V, typename Hash>
+float HashTable<K, V, Hash>::loadFactor() const {
+    return static_cast<float>(numElements) / capacity;
+}
+
+/**
+ * @brief Open-addressing hash table with Robin Hood linear probing and backward-shift deletion.
+ *
+ * Next to every slot there is one byte holding how far the slot's element sits from its home
+ * slot (plus one, so 0 means empty). Inserting walks forward from the home slot, and whenever
+ * the element being placed is further from home than the one already in the slot ("poorer"),
+ * the two trade places and the walk continues with the displaced ("richer") element. That keeps
+ * every run of slots sorted by home position, so:
+ *
+ * - A lookup can stop as soon as it meets an element that is closer to home than the lookup has
+ *   already gone: the key would have taken that slot.
+ * - Probe distances are evened out across keys, so the longest probe stays close to the average
+ *   instead of growing a long tail.
+ * - remove() needs no tombstones. The elements after the removed one are shifted back by one
+ *   slot until one is already at home or the run ends, leaving the table exactly as if the
+ *   removed key had never been inserted. Insert/erase churn therefore cannot make probes longer.
+ *
+ * The table grows when it passes the load factor. Probe distances are kept in one byte per slot;
+ * one that does not fit is stored as the saturated value 255 and recomputed from the key's home
+ * slot when it is read. Only a degenerate hash (hundreds of keys on one run) ever pays for that,
+ * and growing the table would not have split such keys up anyway.
+ *
+ * @tparam K Type of keys.
+ * @tparam V Type of values.
+ * @tparam Hash Hash Table function type. Defaults to std::hash<K>.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class RobinHoodHashTable {
+private:
+    using Pair = std::pair<K, V>;
+
+    // Saturated distance byte: the real distance is recomputed from the key
+    static constexpr uint8_t MaxDistance = 255;
+
+    std::vector<uint8_t> distance; // Probe distance + 1 per slot (at most MaxDistance), 0 for an empty slot
+    Pair* slots;                   // Key-value slots, constructed only while full
+    size_t numElements;            // Number of elements currently in the table
+    size_t capacity;               // Current capacity of the table (number of slots, a power of two)
+    double maxLoadFactor;          // Maximum allowed load factor before resizing
+    Hash hashFunc;                 // Hash Table function object
+    std::allocator<Pair> alloc;    // Raw storage for 'slots'
+
+    /**
+     * @brief Computes the home slot of a key: hashFunc finalized with a mixer, masked to the capacity.
+     *
+     * @param key The key to hash.
+     * @return size_t The computed index within the table.
+     */
+    size_t hashFunction(const K& key) const;
+
+    /**
+     * @brief Index of the slot holding 'key', or 'capacity' if it is not in the table.
+     */
+    size_t findIndex(const K& key) const;
+
+    /**
+     * @brief Probe distance + 1 of the element in the full slot 'index', also past MaxDistance.
+     */
+    size_t distanceAt(size_t index) const;
+
+    /**
+     * @brief Stores probe distance + 1 for slot 'index', saturating at MaxDistance.
+     */
+    void setDistance(size_t index, size_t probe);
+
+    /**
+     * @brief Places an element that is known not to be in the table, displacing richer elements on the way.
+     */
+    void place(Pair&& item);
+
+    /**
+     * @brief Resizes the hash table when the load factor exceeds the threshold.
+     * Doubles the capacity and rehashes all existing key-value pairs.
+     */
+    void resize();
+
+public:
+    /**
+     * @brief Constructs an empty Robin Hood hash table with an initial capacity.
+     *
+     * @param initialCapacity The initial number of slots, rounded up to a power of two. Default is 16.
+     * @param loadFactorThreshold The load factor threshold to trigger resizing. Default is 0.875.
+     */
+    RobinHoodHashTable(size_t initialCapacity = 16, double loadFactorThreshold = 0.875);
+
+    RobinHoodHashTable(const RobinHoodHashTable&) = delete;
+    RobinHoodHashTable& operator=(const RobinHoodHashTable&) = delete;
+
+    /**
+     * @brief Destructor to clean up resources.
+     */
+    ~RobinHoodHashTable();
+
+    /**
+     * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+     *
+     * @param key The key to insert.
+     * @param value The value associated with the key.
+     */
+    void insert(const K& key, const V& value);
+
+    /**
+     * @brief Removes a key, shifting the rest of its run back by one slot.
+     *
+     * @param key The key to remove.
+     * @return true If the key was found and removed.
+     * @return false If the key was not found.
+     */
+    bool remove(const K& key);
+
+    /**
+     * @brief Searches for a key.
+     *
+     * @param key The key to search for.
+     * @return V* Pointer to the value if found, nullptr otherwise.
+     */
+    V* search(const K& key);
+
+    /**
+     * @brief Checks if the table contains a specific key.
+     *
+     * @param key The key to check.
+     * @return true If the key is present.
+     * @return false Otherwise.
+     */
+    bool containsKey(const K& key) const;
+
+    /**
+     * @brief Returns the current number of elements in the table.
+     *
+     * @return size_t The number of key-value pairs stored.
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief Longest probe distance of any element (0 when every element is in its home slot).
+     */
+    size_t maxProbeDistance() const;
+
+    /**
+     * @brief Prints all key-value pairs, with each one's probe distance.
+     */
+    void printTable() const;
+
+    /**
+     * @brief Retrieves all keys stored in the table.
+     *
+     * @return std::vector<K> A vector containing all keys.
+     */
+    std::vector<K> keys() const;
+
+    /**
+     * @brief Clears all elements from the table, making it empty.
+     */
+    void clear();
+
+    /**
+     * @brief Calculates the current load factor of the table.
+     *
+     * @return float The load factor (number of elements divided by capacity).
+     */
+    float loadFactor() const;
+};
+
+template <typename K, typename V, typename Hash>
+RobinHoodHashTable<K, V, Hash>::RobinHoodHashTable(size_t initialCapacity, double loadFactorThreshold)
+        : distance(std::bit_ceil(std::max<size_t>(initialCapacity, 2)), 0),
+          numElements(0), capacity(distance.size()),
+          maxLoadFactor(std::clamp(loadFactorThreshold, 0.1, 0.95)) {
+    slots = alloc.allocate(capacity);
+}
+
+template <typename K, typename V, typename Hash>
+RobinHoodHashTable<K, V, Hash>::~RobinHoodHashTable() {
+    clear();
+    alloc.deallocate(slots, capacity);
+}
+
+template <typename K, typename V, typename Hash>
+size_t RobinHoodHashTable<K, V, Hash>::hashFunction(const K& key) const {
+    // splitmix64 finalizer
+    uint64_t x = hashFunc(key);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<size_t>(x ^ (x >> 31)) & (capacity - 1);
+}
+
+template <typename K, typename V, typename Hash>
+size_t RobinHoodHashTable<K, V, Hash>::findIndex(const K& key) const {
+    size_t index = hashFunction(key);
+    // 'probe' is the distance + 1 the key would have in this slot
+    for (size_t probe = 1; distance[index] != 0; probe++) {
+        size_t resident = distanceAt(index);
+        if (resident < probe) {
+            break;
+        }
+        if (resident == probe && slots[index].first == key) {
+            return index;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+    return capacity;
+}
+
+template <typename K, typename V, typename Hash>
+size_t RobinHoodHashTable<K, V, Hash>::distanceAt(size_t index) const {
+    if (distance[index] < MaxDistance) {
+        return distance[index];
+    }
+    return ((index - hashFunction(slots[index].first)) & (capacity - 1)) + 1;
+}
+
+template <typename K, typename V, typename Hash>
+void RobinHoodHashTable<K, V, Hash>::setDistance(size_t index, size_t probe) {
+    distance[index] = static_cast<uint8_t>(std::min<size_t>(probe, MaxDistance));
+}
+
+template <typename K, typename V, typename Hash>
+void RobinHoodHashTable<K, V, Hash>::place(Pair&& item) {
+    Pair carry = std::move(item);
+    size_t index = hashFunction(carry.first);
+    size_t probe = 1;
+    while (distance[index] != 0) {
+        size_t resident = distanceAt(index);
+        if (resident < probe) {
+            // The resident is richer (closer to home): it gives up the slot and moves on instead
+            std::swap(carry, slots[index]);
+            setDistance(index, probe);
+            probe = resident;
+        }
+        probe++;
+        index = (index + 1) & (capacity - 1);
+    }
+    std::construct_at(slots + index, std::move(carry));
+    setDistance(index, probe);
+}
+
+template <typename K, typename V, typename Hash>
+void RobinHoodHashTable<K, V, Hash>::resize() {
+    std::vector<uint8_t> oldDistance(capacity * 2, 0);
+    oldDistance.swap(distance);
+    Pair* oldSlots = slots;
+    size_t oldCapacity = capacity;
+
+    slots = alloc.allocate(oldCapacity * 2);
+    capacity = oldCapacity * 2;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldDistance[i] != 0) {
+            place(std::move(oldSlots[i]));
+            std::destroy_at(oldSlots + i);
+        }
+    }
+    alloc.deallocate(oldSlots, oldCapacity);
+}
+
+template <typename K, typename V, typename Hash>
+void RobinHoodHashTable<K, V, Hash>::insert(const K& key, const V& value) {
+    size_t index = findIndex(key);
+    if (index != capacity) {
+        slots[index].second = value;
+        return;
+    }
+    if (numElements + 1 > capacity * maxLoadFactor) {
+        resize();
+    }
+    place(Pair(key, value));
+    numElements++;
+}
+
+template <typename K, typename V, typename Hash>
+bool RobinHoodHashTable<K, V, Hash>::remove(const K& key) {
+    size_t index = findIndex(key);
+    if (index == capacity) {
+        return false;
+    }
+
+    // Backward shift: pull every following element that is not at home one slot closer to it
+    std::destroy_at(slots + index);
+    size_t next = (index + 1) & (capacity - 1);
+    while (distance[next] > 1) {
+        size_t shifted = distanceAt(next) - 1;
+        std::construct_at(slots + index, std::move(slots[next]));
+        std::destroy_at(slots + next);
+        setDistance(index, shifted);
+        index = next;
+        next = (next + 1) & (capacity - 1);
+    }
+    distance[index] = 0;
+    numElements--;
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+V* RobinHoodHashTable<K, V, Hash>::search(const K& key) {
+    size_t index = findIndex(key);
+    return index == capacity ? nullptr : &slots[index].second;
+}
+
+template <typename K, typename V, typename Hash>
+bool RobinHoodHashTable<K, V, Hash>::containsKey(const K& key) const {
+    return findIndex(key) != capacity;
+}
+
+template <typename K, typename V, typename Hash>
+size_t RobinHoodHashTable<K, V, Hash>::getSize() const {
+    return numElements;
+}
+
+template <typename K, typename V, typename Hash>
+size_t RobinHoodHashTable<K, V, Hash>::maxProbeDistance() const {
+    size_t longest = 0;
+    for (size_t i = 0; i < capacity; i++) {
+        if (distance[i] != 0) {
+            longest = std::max(longest, distanceAt(i));
+        }
+    }
+    return longest == 0 ? 0 : longest - 1;
+}
+
+template <typename K, typename V, typename Hash>
+void RobinHoodHashTable<K, V, Hash>::printTable() const {
+    for (size_t i = 0; i < capacity; i++) {
+        if (distance[i] != 0) {
+            std::cout << "Slot " << i << ": " << slots[i].first << " -> " << slots[i].second
+                      << " (distance " << distanceAt(i) - 1 << ")" << std::endl;
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash>
+std::vector<K> RobinHoodHashTable<K, V, Hash>::keys() const {
+    std::vector<K> result;
+    result.reserve(numElements);
+    for (size_t i = 0; i < capacity; i++) {
+        if (distance[i] != 0) {
+            result.push_back(slots[i].first);
+        }
+    }
+    return result;
+}
+
+template <typename K, typename V, typename Hash>
+void RobinHoodHashTable<K, V, Hash>::clear() {
+    for (size_t i = 0; i < capacity; i++) {
+        if (distance[i] != 0) {
+            std::destroy_at(slots + i);
+        }
+    }
+    std::fill(distance.begin(), distance.end(), 0);
+    numElements = 0;
+}
+
+template <typename K, typename V, typename Hash>
+float RobinHoodHashTable<K, V, Hash>::loadFactor() const {
+    return static_cast<float>(numElements) / capacity;
+}
+
+static double nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Fills a table of 'capacity' slots to 0.875 load with random 64-bit keys and times
+ * lookups of present and of missing keys, against std::unordered_map holding the same keys.
+ */
+void benchmarkLookups(size_t capacity) {
+    size_t numKeys = capacity / 8 * 7;
+    std::cout << "Lookups at load 0.875, " << numKeys << " keys in " << capacity << " slots" << std::endl;
+
+    std::mt19937_64 rng(17);
+    std::vector<uint64_t> keys(numKeys);
+    for (uint64_t& key : keys) {
+        key = rng();
+    }
+    std::vector<uint64_t> hits(1'000'000);
+    std::vector<uint64_t> misses(1'000'000);
+    for (size_t i = 0; i < hits.size(); i++) {
+        hits[i] = keys[rng() % numKeys];
+        misses[i] = rng();
+    }
+
+    HashTable<uint64_t, uint64_t> table(capacity, 0.875);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    reference.reserve(numKeys);
+    for (uint64_t key : keys) {
+        table.insert(key, key);
+        reference[key] = key;
+    }
+
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t key : hits) {
+        sum += *table.search(key);
+    }
+    double tableHit = nanosSince(start) / hits.size();
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : misses) {
+        sum += table.containsKey(key);
+    }
+    double tableMiss = nanosSince(start) / misses.size();
+
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : hits) {
+        sum -= reference.find(key)->second;
+    }
+    double referenceHit = nanosSince(start) / hits.size();
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : misses) {
+        sum -= reference.count(key);
+    }
+    double referenceMiss = nanosSince(start) / misses.size();
+
+    std::cout << "  HashTable:          hit " << tableHit << " ns, miss " << tableMiss << " ns (load "
+              << table.loadFactor() << ")" << std::endl;
+    std::cout << "  std::unordered_map: hit " << referenceHit << " ns, miss " << referenceMiss << " ns"
+              << (sum == 0 ? "" : " ") << std::endl;
+}
+
+/**
+ * @brief Latency percentiles of 'count' lookups of random keys from 'live', timed one at a time.
+ *
+ * Each sample includes the cost of reading the clock twice, which is the same for every table.
+ */
+template <typename Table>
+std::pair<double, double> lookupPercentiles(Table& table, const std::vector<uint64_t>& live, size_t count,
+                                            std::mt19937_64& rng) {
+    std::vector<double> samples(count);
+    uint64_t sum = 0;
+    for (double& sample : samples) {
+        uint64_t key = live[rng() % live.size()];
+        auto start = std::chrono::steady_clock::now();
+        sum += *table.search(key);
+        sample = nanosSince(start);
+    }
+    std::sort(samples.begin(), samples.end());
+    return {samples[count / 2] + (sum == 0 ? 1e-9 : 0), samples[count * 99 / 100]};
+}
+
+/**
+ * @brief Insert/erase churn on a table of 'capacity' slots holding 0.8 * capacity keys: every
+ * cycle erases a random live key and inserts a fresh one. After each tenth of the cycles the p50
+ * and p99 lookup latency are sampled together with the load factor, so a table whose probes get
+ * longer under churn shows a rising p99, and one that grew to get rid of tombstones shows a
+ * lower load.
+ */
+template <typename Table>
+void benchmarkChurn(const char* name, size_t capacity, size_t cycles) {
+    Table table(capacity, 0.875);
+    std::vector<uint64_t> live(capacity * 4 / 5);
+    std::mt19937_64 rng(18);
+    for (uint64_t& key : live) {
+        key = rng();
+        table.insert(key, key);
+    }
+
+    std::cout << "  " << name << std::endl;
+    const int epochs = 10;
+    auto start = std::chrono::steady_clock::now();
+    for (int epoch = 0; epoch <= epochs; epoch++) {
+        if (epoch > 0) {
+            for (size_t cycle = 0; cycle < cycles / epochs; cycle++) {
+                size_t index = rng() % live.size();
+                table.remove(live[index]);
+                live[index] = rng();
+                table.insert(live[index], live[index]);
+            }
+        }
+        auto [p50, p99] = lookupPercentiles(table, live, 200'000, rng);
+        std::cout << "    after " << cycles / epochs * epoch << " cycles: p50 " << p50 << " ns, p99 " << p99
+                  << " ns (load " << table.loadFactor() << ")" << std::endl;
+    }
+    std::cout << "    " << nanosSince(start) / cycles << " ns per insert/erase cycle" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
     // Create a hash table with string keys and integer values
     HashTable<std::string, int> hashTable;
 
@@ -189,5 +940,20 @@ int main() {
     hashTable.printTable();
     std::cout << "Current size of hash table: " << hashTable.getSize() << std::endl;
 
+    std::cout << std::endl;
+    benchmarkLookups(1 << 16);
+    benchmarkLookups(1 << 20);
+    benchmarkLookups(1 << 24);
+
+    // Pass "full" for the 1B-cycle churn run
+    bool full = argc > 1 && std::string(argv[1]) == "full";
+    size_t cycles = full ? 1'000'000'000 : 20'000'000;
+    size_t churnCapacity = size_t(1) << 20;
+    std::cout << "Insert/erase churn, " << churnCapacity * 4 / 5 << " keys in " << churnCapacity << " slots, "
+              << cycles << " cycles" << std::endl;
+    benchmarkChurn<HashTable<uint64_t, uint64_t>>("HashTable (tombstones)", churnCapacity, cycles);
+    benchmarkChurn<RobinHoodHashTable<uint64_t, uint64_t>>("RobinHoodHashTable (backward shift)", churnCapacity,
+                                                           cycles);
+
     return 0;
 }
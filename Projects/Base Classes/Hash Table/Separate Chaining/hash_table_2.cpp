@@ -1,64 +1,392 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <string>
 #include <utility> // for std::pair
 #include <functional> // for std::hash
+#include <algorithm>
+#include <bit> // for std::bit_width
+#include <memory> // for std::construct_at, std::uninitialized_move_n
+#include <cstdint>
+#include <chrono>
+#include <random>
+
+#if defined(__GLIBC__)
+#include <malloc.h> // for malloc_trim
+#endif
+
+/**
+ * @brief A bucket that chains its pairs in a std::list: one heap node per pair.
+ *
+ * Moving a pair to another ListBucket re-links its node, so nothing is copied during a resize.
+ */
+template <typename K, typename V>
+class ListBucket {
+private:
+    std::list<std::pair<K, V>> items;
+
+public:
+    using Pair = std::pair<K, V>;
+
+    Pair* find(const K& key) {
+        for (Pair& pair : items) {
+            if (pair.first == key) {
+                return &pair;
+            }
+        }
+        return nullptr;
+    }
+
+    const Pair* find(const K& key) const {
+        return const_cast<ListBucket*>(this)->find(key);
+    }
+
+    void emplace(const K& key, const V& value) {
+        items.emplace_back(key, value);
+    }
+
+    bool erase(const K& key) {
+        for (auto it = items.begin(); it != items.end(); ++it) {
+            if (it->first == key) {
+                items.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Moves every pair into the bucket 'route(key)' returns, leaving this bucket empty.
+     */
+    template <typename Route>
+    void drainInto(Route route) {
+        while (!items.empty()) {
+            ListBucket& to = route(items.front().first);
+            to.items.splice(to.items.end(), items, items.begin());
+        }
+    }
+
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const Pair& pair : items) {
+            visit(pair);
+        }
+    }
+
+    void clear() {
+        items.clear();
+    }
+};
+
+/**
+ * @brief A bucket that keeps its first few pairs inline and the rest in one contiguous vector.
+ *
+ * The inline slots are sized so that the whole bucket (count, slots, overflow vector) is about
+ * one cache line: two pairs of 8-byte keys and values. At load factors up to about 2 most
+ * chains fit inline, so a lookup reads the one line the bucket array already brought in, and
+ * an insert into a bucket with a free slot does not allocate at all. Longer chains continue in
+ * the overflow vector, which still keeps them contiguous instead of one node per pair.
+ *
+ * Pairs do not keep their order: erase() fills the hole with the bucket's last pair.
+ *
+ * @tparam InlineSlots Pairs stored inside the bucket itself.
+ */
+template <typename K, typename V,
+          size_t InlineSlots = std::max<size_t>(1, (64 - sizeof(uint32_t) - sizeof(std::vector<std::pair<K, V>>)) /
+                                                       sizeof(std::pair<K, V>))>
+class InlineBucket {
+public:
+    using Pair = std::pair<K, V>;
+
+private:
+    uint32_t count;                                         // Pairs in the inline slots
+    alignas(Pair) unsigned char storage[InlineSlots * sizeof(Pair)];
+    std::vector<Pair> overflow;                             // Pairs past the inline slots
+
+    Pair* slots() {
+        return reinterpret_cast<Pair*>(storage);
+    }
+
+    const Pair* slots() const {
+        return reinterpret_cast<const Pair*>(storage);
+    }
+
+    void push(Pair&& pair) {
+        if (count < InlineSlots) {
+            std::construct_at(slots() + count, std::move(pair));
+            count++;
+        } else {
+            overflow.push_back(std::move(pair));
+        }
+    }
+
+public:
+    InlineBucket() : count(0) {}
+
+    InlineBucket(InlineBucket&& other) noexcept : count(other.count), overflow(std::move(other.overflow)) {
+        std::uninitialized_move_n(other.slots(), count, slots());
+        other.clear();
+    }
+
+    InlineBucket(const InlineBucket&) = delete;
+    InlineBucket& operator=(const InlineBucket&) = delete;
+
+    ~InlineBucket() {
+        std::destroy_n(slots(), count);
+    }
+
+    Pair* find(const K& key) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (slots()[i].first == key) {
+                return &slots()[i];
+            }
+        }
+        for (Pair& pair : overflow) {
+            if (pair.first == key) {
+                return &pair;
+            }
+        }
+        return nullptr;
+    }
+
+    const Pair* find(const K& key) const {
+        return const_cast<InlineBucket*>(this)->find(key);
+    }
+
+    void emplace(const K& key, const V& value) {
+        if (count < InlineSlots) {
+            std::construct_at(slots() + count, key, value);
+            count++;
+        } else {
+            overflow.emplace_back(key, value);
+        }
+    }
+
+    bool erase(const K& key) {
+        Pair* pair = find(key);
+        if (pair == nullptr) {
+            return false;
+        }
+        // Fill the hole with the last pair of the bucket
+        if (!overflow.empty()) {
+            if (pair != &overflow.back()) {
+                *pair = std::move(overflow.back());
+            }
+            overflow.pop_back();
+        } else {
+            if (pair != &slots()[count - 1]) {
+                *pair = std::move(slots()[count - 1]);
+            }
+            std::destroy_at(slots() + count - 1);
+            count--;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Moves every pair into the bucket 'route(key)' returns, leaving this bucket empty.
+     */
+    template <typename Route>
+    void drainInto(Route route) {
+        for (uint32_t i = 0; i < count; i++) {
+            route(slots()[i].first).push(std::move(slots()[i]));
+        }
+        for (Pair& pair : overflow) {
+            route(pair.first).push(std::move(pair));
+        }
+        clear();
+    }
+
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (uint32_t i = 0; i < count; i++) {
+            visit(slots()[i]);
+        }
+        for (const Pair& pair : overflow) {
+            visit(pair);
+        }
+    }
+
+    void clear() {
+        std::destroy_n(slots(), count);
+        count = 0;
+        overflow = {};
+    }
+};
 
 /**
  * @brief HashTable class
  *
- * This class provides a skeleton for a generic Hash Table Table, which stores key-value pairs.
- * It uses separate chaining with linked lists to handle collisions.
+ * This class provides a generic Hash Table Table, which stores key-value pairs.
+ * It uses separate chaining to handle collisions. How a chain is stored is up to the Bucket
+ * type: ListBucket (a std::list, one heap node per pair) or InlineBucket (a few pairs inline in
+ * the bucket array, the rest in one vector per bucket).
  * The table resizes itself when the load factor exceeds a certain threshold to maintain
  * efficient average-case time complexity for operations.
  *
+ * The bucket count is a power of two and a key's bucket is taken from the top bits of its
+ * (multiplied) hash. Doubling the table therefore splits old bucket i into new buckets 2i and
+ * 2i + 1, which is what makes the incremental resize below cheap:
+ *
+ * - Stop-the-world mode (the default) moves every chain into the new bucket array in one go.
+ * - Incremental mode keeps the old bucket array next to the new one and moves the chains of a
+ *   few old buckets (MigrateBuckets) on every insert, search or remove, in bucket order. The
+ *   new array is only reserved up front; the two buckets an old bucket splits into are appended
+ *   when it is migrated, so no operation ever touches more than a few buckets. While the move
+ *   is running, a key whose old bucket has not been migrated yet is still found in the old
+ *   array, and every other key in the new one.
+ *
+ * Moving a ListBucket chain re-links its list nodes with splice, so no element is copied or
+ * reallocated; an InlineBucket chain is moved pair by pair.
+ *
  * @tparam K Type of keys.
  * @tparam V Type of values.
+ * @tparam Bucket How each chain is stored. Defaults to ListBucket.
  */
-template <typename K, typename V>
+template <typename K, typename V, typename Bucket = ListBucket<K, V>>
 class HashTable {
 private:
     // Type alias for a key-value pair
     using Pair = std::pair<K, V>;
 
-    // Vector of lists to store key-value pairs for separate chaining
-    std::vector<std::list<Pair>> table;
+    // Vector of buckets, each holding one chain of key-value pairs
+    std::vector<Bucket> table;
+
+    // The previous bucket array while an incremental resize is running, empty otherwise
+    std::vector<Bucket> oldTable;
+
+    // Old buckets [0, migrated) have been moved into 'table'
+    size_t migrated;
 
     // Number of elements stored in the hash table
     size_t numElements;
 
-    // Current capacity of the hash table (number of buckets)
+    // Current capacity of the hash table (number of buckets, a power of two)
     size_t capacity;
 
+    // log2(capacity)
+    int bits;
+
     // Maximum load factor before resizing
-    const double maxLoadFactor = 0.75;
+    double maxLoadFactor;
+
+    // Spread the resize over the following operations instead of doing it all at once
+    bool incremental;
+
+    // Old buckets moved per operation during an incremental resize. The next resize is due
+    // after another maxLoadFactor * capacity inserts, far more than the capacity / 2 / 4 steps this needs.
+    static constexpr size_t MigrateBuckets = 4;
+
+    // Emptied old buckets destroyed per operation once every chain has moved. Destroying
+    // millions of empty lists in one go is itself a pause of tens of milliseconds.
+    static constexpr size_t RetireBuckets = 64;
 
     /**
      * @brief Hash Table function to compute the index for a given key.
-     * Uses std::hash by default, but can be customized.
+     * Uses std::hash, multiplied by 2^64 / phi so that the top bits depend on every input bit,
+     * and keeps the top 'tableBits' bits.
      *
      * @param key The key to hash.
+     * @param tableBits log2 of the number of buckets of the table the index is for.
      * @return size_t The index corresponding to the key.
      */
-    size_t hashFunction(const K& key) const {
+    size_t hashFunction(const K& key, int tableBits) const {
+        uint64_t hash = static_cast<uint64_t>(std::hash<K>{}(key)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(hash >> (64 - tableBits));
+    }
+
+    bool migrating() const {
+        return !oldTable.empty();
+    }
+
+    /**
+     * @brief The chain that holds (or would hold) 'key', in whichever array owns its bucket right now.
+     */
+    Bucket& bucketFor(const K& key) {
+        if (migrating()) {
+            size_t oldIndex = hashFunction(key, bits - 1);
+            if (oldIndex >= migrated) {
+                return oldTable[oldIndex];
+            }
+        }
+        return table[hashFunction(key, bits)];
+    }
+
+    const Bucket& bucketFor(const K& key) const {
+        return const_cast<HashTable*>(this)->bucketFor(key);
+    }
+
+    /**
+     * @brief Moves the chain of old bucket 'migrated' into new buckets 2 * migrated and 2 * migrated + 1.
+     */
+    void migrateBucket() {
+        table.emplace_back();
+        table.emplace_back();
+        oldTable[migrated].drainInto([this](const K& key) -> Bucket& { return table[hashFunction(key, bits)]; });
+        migrated++;
+    }
+
+    /**
+     * @brief One bounded step of an incremental resize.
+     *
+     * Moves the next MigrateBuckets old chains, or once they have all moved, destroys the next
+     * RetireBuckets emptied old buckets from the back. The resize is over when the old array is empty.
+     */
+    void migrateStep() {
+        if (!migrating()) {
+            return;
+        }
+        if (migrated < oldTable.size()) {
+            for (size_t step = 0; step < MigrateBuckets && migrated < oldTable.size(); step++) {
+                migrateBucket();
+            }
+            return;
+        }
+        for (size_t step = 0; step < RetireBuckets && !oldTable.empty(); step++) {
+            oldTable.pop_back();
+        }
+        if (oldTable.empty()) {
+            oldTable = std::vector<Bucket>();
+        }
     }
 
     /**
      * @brief Resize the hash table when the load factor exceeds the threshold.
-     * Doubles the capacity and rehashes all existing key-value pairs.
+     * Doubles the capacity and rehashes all existing key-value pairs, either right away or,
+     * in incremental mode, a few buckets per following operation.
      */
     void resize() {
+        // A resize that is still running has to finish before the next one starts
+        while (migrating()) {
+            migrateStep();
+        }
 
+        oldTable.swap(table);
+        table.reserve(capacity * 2);
+        capacity *= 2;
+        bits++;
+        migrated = 0;
+        if (!incremental) {
+            while (migrated < oldTable.size()) {
+                migrateBucket();
+            }
+            oldTable = std::vector<Bucket>();
+        }
     }
 
 public:
     /**
      * @brief Construct an empty Hash Table Table with an initial capacity.
      *
-     * @param initialCapacity The initial number of buckets. Default is 16.
+     * @param initialCapacity The initial number of buckets, rounded up to a power of two. Default is 16.
+     * @param incrementalResize Spread each resize over the following operations instead of
+     *                          rehashing everything in the insert that triggers it. Default is false.
+     * @param loadFactorThreshold Average chain length that triggers a resize. Default is 0.75.
      */
-    HashTable(size_t initialCapacity = 16)
-            : table(initialCapacity), numElements(0), capacity(initialCapacity) {}
+    HashTable(size_t initialCapacity = 16, bool incrementalResize = false, double loadFactorThreshold = 0.75)
+            : table(std::bit_ceil(std::max<size_t>(initialCapacity, 2))), migrated(0), numElements(0),
+              capacity(table.size()), bits(std::bit_width(capacity) - 1), maxLoadFactor(loadFactorThreshold),
+              incremental(incrementalResize) {}
 
     /**
      * @brief Destroy the Hash Table Table, releasing all resources.
@@ -73,7 +401,17 @@ public:
      * @param value The value associated with the key.
      */
     void insert(const K& key, const V& value) {
-
+        migrateStep();
+        Bucket& bucket = bucketFor(key);
+        if (Pair* pair = bucket.find(key)) {
+            pair->second = value;
+            return;
+        }
+        bucket.emplace(key, value);
+        numElements++;
+        if (numElements > capacity * maxLoadFactor) {
+            resize();
+        }
     }
 
     /**
@@ -84,6 +422,12 @@ public:
      * @return false If the key was not found.
      */
     bool remove(const K& key) {
+        migrateStep();
+        if (!bucketFor(key).erase(key)) {
+            return false;
+        }
+        numElements--;
+        return true;
     }
 
     /**
@@ -93,6 +437,9 @@ public:
      * @return V* Pointer to the value if found, nullptr otherwise.
      */
     V* search(const K& key) {
+        migrateStep();
+        Pair* pair = bucketFor(key).find(key);
+        return pair == nullptr ? nullptr : &pair->second;
     }
 
     /**
@@ -103,7 +450,7 @@ public:
      * @return false Otherwise.
      */
     bool contains(const K& key) const {
-
+        return bucketFor(key).find(key) != nullptr;
     }
 
     /**
@@ -112,6 +459,7 @@ public:
      * @return size_t The number of key-value pairs stored.
      */
     size_t size() const {
+        return numElements;
     }
 
     /**
@@ -119,18 +467,127 @@ public:
      * Iterates through each bucket and prints the contents.
      */
     void printAll() const {
-
+        for (size_t i = 0; i < table.size(); i++) {
+            table[i].forEach([i](const Pair& pair) {
+                std::cout << "Bucket " << i << ": " << pair.first << " -> " << pair.second << "\n";
+            });
+        }
+        for (size_t i = migrated; i < oldTable.size(); i++) {
+            oldTable[i].forEach([i](const Pair& pair) {
+                std::cout << "Old bucket " << i << ": " << pair.first << " -> " << pair.second << "\n";
+            });
+        }
     }
 
     /**
      * @brief Clear all elements from the Hash Table Table, making it empty.
      */
     void clear() {
-
+        // Finish a running resize first, so the table is left with all its buckets
+        while (migrating()) {
+            migrateStep();
+        }
+        for (Bucket& bucket : table) {
+            bucket.clear();
+        }
+        numElements = 0;
     }
 };
 
-int main() {
+static double nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Inserts 'numKeys' random keys one at a time, timing every insert, and prints a
+ * latency histogram. The worst inserts are the ones that trigger a resize.
+ */
+void benchmarkInsertLatency(size_t numKeys, bool incremental) {
+    std::cout << (incremental ? "  incremental resize" : "  stop-the-world resize") << std::endl;
+
+    // Bucket b counts inserts that took less than 4^b * 64 ns (the last one counts the rest)
+    const char* labels[] = {"< 64 ns", "< 256 ns", "< 1 us", "< 4 us", "< 16 us", "< 64 us",
+                            "< 256 us", "< 1 ms", "< 4 ms", "< 16 ms", "< 64 ms", ">= 64 ms"};
+    const int numBins = 12;
+    std::vector<size_t> histogram(numBins, 0);
+    double worst = 0;
+
+#if defined(__GLIBC__)
+    // The nodes a previous run freed wait in the allocator's fast bins, and glibc merges them all
+    // on the next large allocation. Let that happen here instead of inside a timed insert.
+    malloc_trim(0);
+#endif
+
+    HashTable<uint64_t, uint64_t> table(16, incremental);
+    std::mt19937_64 rng(19);
+    auto total = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        uint64_t key = rng();
+        auto start = std::chrono::steady_clock::now();
+        table.insert(key, i);
+        double nanos = nanosSince(start);
+
+        int bin = 0;
+        for (double limit = 64; bin < numBins - 1 && nanos >= limit; limit *= 4) {
+            bin++;
+        }
+        histogram[bin]++;
+        worst = std::max(worst, nanos);
+    }
+    double totalNanos = nanosSince(total);
+
+    for (int bin = 0; bin < numBins; bin++) {
+        if (histogram[bin] != 0) {
+            std::cout << "    " << labels[bin] << ": " << histogram[bin] << "\n";
+        }
+    }
+    std::cout << "    worst insert " << worst / 1e6 << " ms, average " << totalNanos / numKeys << " ns" << std::endl;
+}
+
+/**
+ * @brief Builds a table of 2^20 buckets at a fixed load factor (no resize) and times inserts,
+ * lookups of present keys and lookups of missing keys.
+ */
+template <typename Bucket>
+void benchmarkChains(const char* name, double loadFactor) {
+    const size_t buckets = 1 << 20;
+    size_t numKeys = static_cast<size_t>(buckets * loadFactor);
+    std::mt19937_64 rng(20);
+    std::vector<uint64_t> keys(numKeys);
+    for (uint64_t& key : keys) {
+        key = rng();
+    }
+    std::vector<uint64_t> hits(1'000'000);
+    std::vector<uint64_t> misses(1'000'000);
+    for (size_t i = 0; i < hits.size(); i++) {
+        hits[i] = keys[rng() % numKeys];
+        misses[i] = rng();
+    }
+
+    HashTable<uint64_t, uint64_t, Bucket> table(buckets, false, loadFactor + 1);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t key : keys) {
+        table.insert(key, key);
+    }
+    double insertNanos = nanosSince(start) / numKeys;
+
+    uint64_t sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : hits) {
+        sum += *table.search(key);
+    }
+    double hitNanos = nanosSince(start) / hits.size();
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : misses) {
+        sum += table.contains(key);
+    }
+    double missNanos = nanosSince(start) / misses.size();
+
+    std::cout << "    " << name << "insert " << insertNanos << " ns, hit " << hitNanos << " ns, miss "
+              << missNanos << " ns" << (sum == 0 ? " " : "") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
     // Create a hash table with integer keys and string values
     HashTable<int, std::string> hashTable;
 
@@ -138,7 +595,7 @@ int main() {
     hashTable.insert(1, "One");
     hashTable.insert(2, "Two");
     hashTable.insert(3, "Three");
-    hashTable.insert(17, "Seventeen"); // This will collide with key 1 if capacity is 16
+    hashTable.insert(17, "Seventeen"); // May share a bucket with another key
 
     std::cout << "Hash Table Table contents after insertions:\n";
     hashTable.printAll();
@@ -173,5 +630,19 @@ int main() {
     std::cout << "\nHash Table Table cleared.\n";
     std::cout << "Current size: " << hashTable.size() << "\n";
 
+    // Pass "full" for the 50M-key run
+    bool full = argc > 1 && std::string(argv[1]) == "full";
+    size_t numKeys = full ? 50'000'000 : 5'000'000;
+    std::cout << "\nInsert latency, " << numKeys << " random keys" << std::endl;
+    benchmarkInsertLatency(numKeys, false);
+    benchmarkInsertLatency(numKeys, true);
+
+    std::cout << "\nChain layouts, 2^20 buckets, uint64_t keys and values" << std::endl;
+    for (double loadFactor : {0.5, 1.0, 1.5, 2.0}) {
+        std::cout << "  load factor " << loadFactor << std::endl;
+        benchmarkChains<ListBucket<uint64_t, uint64_t>>("std::list:    ", loadFactor);
+        benchmarkChains<InlineBucket<uint64_t, uint64_t>>("inline array: ", loadFactor);
+    }
+
     return 0;
 }
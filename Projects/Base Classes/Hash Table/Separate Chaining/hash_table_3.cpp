@@ -2,19 +2,37 @@
 #include <vector>
 #include <utility>      // for std::pair
 #include <functional>   // for std::hash
+#include <memory>       // for std::construct_at, std::destroy_at
+#include <type_traits>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <random>
+
+#if defined(__GLIBC__)
+#include <malloc.h> // for mallinfo2
+#endif
 
 /**
  * @brief HashTable class using custom Node-based separate chaining.
  *
- * This class provides a skeleton for a generic Hash Table Table, which stores key-value pairs.
- * It uses separate chaining with custom singly linked lists to handle collisions.
+ * A generic hash table storing key-value pairs. It uses separate chaining with custom singly
+ * linked lists to handle collisions: new keys go to the head of their bucket's list, and
+ * inserting an existing key updates its value in place.
  * The table resizes itself when the load factor exceeds a certain threshold to maintain
  * efficient average-case time complexity for operations.
  *
+ * Nodes come from a per-table NodePool rather than from one global allocation each: a free list of
+ * removed nodes in front of a bump pointer into the newest slab. Nodes inserted together end up
+ * next to each other, there is no per-node allocator header, and clear() hands every slab back
+ * at once instead of freeing node by node.
+ *
  * @tparam K Type of keys.
  * @tparam V Type of values.
+ * @tparam Pooled Take nodes from the NodePool (the default), or new/delete every node.
  */
-template <typename K, typename V>
+template <typename K, typename V, bool Pooled = true>
 class HashTable {
 private:
     // Node structure for separate chaining
@@ -26,6 +44,84 @@ private:
         Node(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
     };
 
+    /**
+     * @brief Slab allocator for Node.
+     *
+     * A removed node goes onto the free list and is the next one handed out. Otherwise nodes are
+     * cut from the newest slab, and a new slab is allocated once it is used up.
+     */
+    class NodePool {
+    private:
+        // A free node's storage holds the free-list link
+        union Slot {
+            Slot* next;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        // Aim for slabs of about 256 KiB, but never fewer than 16 nodes per slab
+        static constexpr size_t SlotsPerSlab = std::max<size_t>(16, (256 * 1024) / sizeof(Slot));
+
+        std::vector<Slot*> slabs;   // Every slab allocated so far
+        Slot* bump = nullptr;       // Next never-used slot in the newest slab
+        Slot* slabEnd = nullptr;    // End of the newest slab
+        Slot* freeList = nullptr;   // Slots given back by destroy()
+
+    public:
+        NodePool() = default;
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        ~NodePool() {
+            release();
+        }
+
+        Node* create(const K& key, const V& value) {
+            if constexpr (!Pooled) {
+                return new Node(key, value);
+            }
+            Slot* slot = freeList;
+            if (slot != nullptr) {
+                freeList = slot->next;
+            } else {
+                if (bump == slabEnd) {
+                    bump = new Slot[SlotsPerSlab];
+                    slabEnd = bump + SlotsPerSlab;
+                    slabs.push_back(bump);
+                }
+                slot = bump++;
+            }
+            return std::construct_at(reinterpret_cast<Node*>(slot->storage), key, value);
+        }
+
+        void destroy(Node* node) {
+            if constexpr (!Pooled) {
+                delete node;
+                return;
+            }
+            std::destroy_at(node);
+            Slot* slot = reinterpret_cast<Slot*>(node);
+            slot->next = freeList;
+            freeList = slot;
+        }
+
+        /**
+         * @brief Free every slab. The nodes in them must have been destroyed already, or need no destructor.
+         */
+        void release() {
+            for (Slot* slab : slabs) {
+                delete[] slab;
+            }
+            slabs.clear();
+            bump = nullptr;
+            slabEnd = nullptr;
+            freeList = nullptr;
+        }
+    };
+
+    // Nodes are visited one by one on clear() only if they need destructing or come from new
+    static constexpr bool ReleaseWithoutWalk =
+        Pooled && std::is_trivially_destructible_v<K> && std::is_trivially_destructible_v<V>;
+
     // Vector of pointers to the head nodes of the chains
     std::vector<Node*> table;
 
@@ -38,6 +134,9 @@ private:
     // Maximum load factor before resizing
     const double maxLoadFactor = 0.75;
 
+    // Where every Node of this table lives
+    NodePool pool;
+
     /**
      * @brief Hash Table function to compute the index for a given key.
      * Uses std::hash by default, but can be customized.
@@ -46,7 +145,7 @@ private:
      * @return size_t The index corresponding to the key.
      */
     size_t hashFunction(const K& key) const {
-
+        return std::hash<K>{}(key) % capacity;
     }
 
     /**
@@ -54,25 +153,40 @@ private:
      * Doubles the capacity and rehashes all existing key-value pairs.
      */
     void resize() {
-
+        std::vector<Node*> newTable(capacity * 2, nullptr);
+        capacity *= 2;
+        for (Node* head : table) {
+            while (head != nullptr) {
+                Node* nextNode = head->next;
+                size_t index = hashFunction(head->key);
+                head->next = newTable[index];
+                newTable[index] = head;
+                head = nextNode;
+            }
+        }
+        table.swap(newTable);
     }
 
 public:
     /**
      * @brief Construct an empty Hash Table Table with an initial capacity.
      *
-     * @param initialCapacity The initial number of buckets. Default is 16.
+     * @param initialCapacity The initial number of buckets, at least 1. Default is 16.
      */
     HashTable(size_t initialCapacity = 16)
-            : table(initialCapacity, nullptr), numElements(0), capacity(initialCapacity) {}
+            : table(std::max<size_t>(initialCapacity, 1), nullptr), numElements(0),
+              capacity(std::max<size_t>(initialCapacity, 1)) {}
 
     /**
      * @brief Destroy the Hash Table Table, releasing all resources.
      */
     ~HashTable() {
-
+        clear();
     }
 
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
     /**
      * @brief Insert a key-value pair into the Hash Table Table.
      * If the key already exists, its value is updated.
@@ -81,7 +195,20 @@ public:
      * @param value The value associated with the key.
      */
     void insert(const K& key, const V& value) {
-
+        size_t index = hashFunction(key);
+        for (Node* node = table[index]; node != nullptr; node = node->next) {
+            if (node->key == key) {
+                node->value = value;
+                return;
+            }
+        }
+        Node* newNode = pool.create(key, value);
+        newNode->next = table[index];
+        table[index] = newNode;
+        numElements++;
+        if (numElements > capacity * maxLoadFactor) {
+            resize();
+        }
     }
 
     /**
@@ -92,7 +219,16 @@ public:
      * @return false If the key was not found.
      */
     bool remove(const K& key) {
-
+        for (Node** link = &table[hashFunction(key)]; *link != nullptr; link = &(*link)->next) {
+            Node* node = *link;
+            if (node->key == key) {
+                *link = node->next;
+                pool.destroy(node);
+                numElements--;
+                return true;
+            }
+        }
+        return false;
     }
 
     /**
@@ -102,7 +238,12 @@ public:
      * @return V* Pointer to the value if found, nullptr otherwise.
      */
     V* search(const K& key) const {
-
+        for (Node* node = table[hashFunction(key)]; node != nullptr; node = node->next) {
+            if (node->key == key) {
+                return &node->value;
+            }
+        }
+        return nullptr;
     }
 
     /**
@@ -113,7 +254,7 @@ public:
      * @return false Otherwise.
      */
     bool contains(const K& key) const {
-
+        return search(key) != nullptr;
     }
 
     /**
@@ -122,7 +263,7 @@ public:
      * @return size_t The number of key-value pairs stored.
      */
     size_t size() const {
-
+        return numElements;
     }
 
     /**
@@ -130,13 +271,143 @@ public:
      * Iterates through each bucket and prints the contents.
      */
     void printAll() const {
-
+        for (size_t i = 0; i < capacity; i++) {
+            for (Node* node = table[i]; node != nullptr; node = node->next) {
+                std::cout << "Bucket " << i << ": " << node->key << " -> " << node->value << "\n";
+            }
+        }
     }
 
     /**
      * @brief Clear all elements from the Hash Table Table, making it empty.
+     * The bucket array keeps its size; the node slabs are all freed in one step.
      */
     void clear() {
-
+        if constexpr (ReleaseWithoutWalk) {
+            std::fill(table.begin(), table.end(), nullptr);
+        } else {
+            for (Node*& head : table) {
+                while (head != nullptr) {
+                    Node* nextNode = head->next;
+                    if constexpr (Pooled) {
+                        std::destroy_at(head);
+                    } else {
+                        delete head;
+                    }
+                    head = nextNode;
+                }
+            }
+        }
+        pool.release();
+        numElements = 0;
     }
 };
+
+// Lock Free/hash_table_1.cpp includes this file for HashTable and defines this to leave out main
+#ifndef HASH_TABLE_3_NO_MAIN
+
+static double nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bytes currently handed out by malloc, including blocks it mapped directly, or 0 where that cannot be asked
+static size_t heapInUse() {
+#if defined(__GLIBC__)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Inserts numKeys random uint32_t keys, churns them (remove one, insert another), then clears,
+ * and prints the time per operation and the heap growth.
+ */
+template <bool Pooled>
+void benchmarkNodes(const char* name, size_t numKeys) {
+    std::mt19937 rng(25);
+    std::vector<uint32_t> keys(numKeys);
+    for (uint32_t& key : keys) {
+        key = static_cast<uint32_t>(rng());
+    }
+
+    // Room for every key up front, so the heap growth below is the nodes alone
+    auto* hashTable = new HashTable<uint32_t, uint32_t, Pooled>(numKeys * 2);
+    size_t heapBefore = heapInUse();
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t key : keys) {
+        hashTable->insert(key, key);
+    }
+    double insertNanos = nanosSince(start) / numKeys;
+    double heapBytes = static_cast<double>(heapInUse() - heapBefore);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        hashTable->remove(keys[i]);
+        keys[i] = static_cast<uint32_t>(rng());
+        hashTable->insert(keys[i], keys[i]);
+    }
+    double churnNanos = nanosSince(start) / numKeys;
+
+    start = std::chrono::steady_clock::now();
+    hashTable->clear();
+    double clearMillis = nanosSince(start) / 1e6;
+    delete hashTable;
+
+    std::cout << "    " << name << "insert " << insertNanos << " ns, remove + insert " << churnNanos
+              << " ns, clear " << clearMillis << " ms, heap " << heapBytes / numKeys << " B/key" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Create a hash table with integer keys and string values
+    HashTable<int, std::string> hashTable;
+
+    // Test insertion
+    hashTable.insert(1, "One");
+    hashTable.insert(2, "Two");
+    hashTable.insert(3, "Three");
+    hashTable.insert(17, "Seventeen"); // May share a bucket with another key
+
+    std::cout << "Hash Table Table contents after insertions:\n";
+    hashTable.printAll();
+
+    // Test search
+    int searchKey = 3;
+    std::string* value = hashTable.search(searchKey);
+    if (value) {
+        std::cout << "\nFound key " << searchKey << " with value: " << *value << "\n";
+    } else {
+        std::cout << "\nKey " << searchKey << " not found.\n";
+    }
+
+    // Test removal
+    int removeKey = 2;
+    if (hashTable.remove(removeKey)) {
+        std::cout << "\nKey " << removeKey << " removed successfully.\n";
+    } else {
+        std::cout << "\nKey " << removeKey << " not found.\n";
+    }
+
+    // Test contains
+    int checkKey = 17;
+    std::cout << "\nHash Table Table contains key " << checkKey << ": "
+              << (hashTable.contains(checkKey) ? "Yes" : "No") << "\n";
+
+    // Test clear
+    hashTable.clear();
+    std::cout << "\nHash Table Table cleared.\n";
+    std::cout << "Current size: " << hashTable.size() << "\n";
+
+    // Pass "full" for the 50M-key run
+    bool full = argc > 1 && std::string(argv[1]) == "full";
+    for (size_t numKeys : {size_t{100'000}, full ? size_t{50'000'000} : size_t{5'000'000}}) {
+        std::cout << "\n" << numKeys << " uint32_t keys and values" << std::endl;
+        benchmarkNodes<false>("new/delete: ", numKeys);
+        benchmarkNodes<true>("node pool:  ", numKeys);
+    }
+
+    return 0;
+}
+
+#endif
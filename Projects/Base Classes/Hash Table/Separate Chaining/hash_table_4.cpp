@@ -0,0 +1,542 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional> // for std::hash
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <bit> // for std::bit_ceil, std::countr_zero
+#include <cmath>
+#include <cstdint>
+#include <chrono>
+#include <random>
+
+/**
+ * @brief A separate-chaining hash table that many threads can use at once.
+ *
+ * The buckets are split over a fixed number of lock stripes: bucket i belongs to stripe
+ * i & (stripes - 1), and every operation on a key holds only that key's stripe lock, shared for
+ * search/contains and exclusive for insert/remove. Each stripe lock is a reader-writer lock in
+ * its own cache line, so readers of a hot key do not block each other and operations on
+ * different stripes share no cache lines.
+ *
+ * The bucket count is a power of two, at least the stripe count, and a key's bucket is taken from
+ * the low bits of its hash. Doubling the table splits old bucket i into new buckets i and
+ * i + oldCapacity, and both belong to the same stripe as bucket i. Moving one chain to the new
+ * array therefore needs only that stripe's lock, and a key's stripe never changes.
+ *
+ * Resizing is cooperative. The thread whose insert pushes its stripe past the load factor allocates
+ * the new bucket array and publishes it. Every insert and remove then claims the next
+ * MigrateBuckets old buckets and moves their chains before it returns. Each old bucket carries a
+ * flag saying it has moved, so a lookup that holds the stripe lock knows which array to search.
+ * Only publishing the new array and retiring the old one lock all stripes, and both are O(stripes).
+ *
+ * Element counts are kept per stripe, so inserts do not all write one shared counter. A resize
+ * starts once any stripe holds more than its share, maxLoadFactor * capacity / stripes.
+ *
+ * @tparam K Type of keys.
+ * @tparam V Type of values.
+ */
+template <typename K, typename V>
+class ConcurrentHashTable {
+private:
+    // Node structure for separate chaining
+    struct Node {
+        K key;
+        V value;
+        size_t hash;  // Cached so that migrating a chain never hashes a key again
+        Node* next;
+
+        Node(const K& k, const V& v, size_t h, Node* n) : key(k), value(v), hash(h), next(n) {}
+    };
+
+    // A bucket array. Every bucket, and its migrated flag, is guarded by the lock of its stripe.
+    struct Table {
+        std::vector<Node*> buckets;
+        size_t mask;
+        // While this is the old array of a resize, migrated[i] is set once bucket i has moved
+        std::vector<uint8_t> migrated;
+
+        explicit Table(size_t capacity) : buckets(capacity, nullptr), mask(capacity - 1) {}
+    };
+
+    // One lock stripe
+    struct alignas(64) Stripe {
+        std::shared_mutex lock;
+        // Number of elements in the buckets of this stripe
+        size_t count = 0;
+    };
+
+    std::vector<Stripe> stripes;
+    size_t stripeMask;
+
+    // Both pointers change only while every stripe lock is held exclusively, so reading them
+    // under any one stripe lock is safe
+    Table* current;
+    // The array a resize is moving the chains into, nullptr when no resize is running
+    Table* next;
+
+    // Maximum load factor before resizing
+    double maxLoadFactor;
+
+    // Set by the thread that starts a resize, cleared once that resize has finished
+    std::atomic<bool> resizing;
+
+    // Migration work queue: ((log2(old capacity) + 1) << 48) | next unclaimed old bucket, or 0 when no
+    // resize is running. The table never shrinks, so no two resizes publish the same word and a
+    // stale claim can never succeed.
+    std::atomic<uint64_t> migrateCursor;
+
+    // Old buckets moved so far by the running resize
+    std::atomic<size_t> migratedBuckets;
+
+    // Old buckets claimed by one helping insert or remove
+    static constexpr size_t MigrateBuckets = 16;
+
+    static constexpr int CursorShift = 48;
+
+    /**
+     * @brief Hash Table function: std::hash finished with the splitmix64 mixer, so that the low bits
+     * used for the bucket and the stripe depend on every input bit.
+     *
+     * @param key The key to hash.
+     * @return size_t The full hash of the key.
+     */
+    static size_t hashFunction(const K& key) {
+        uint64_t hash = static_cast<uint64_t>(std::hash<K>{}(key));
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<size_t>(hash ^ (hash >> 31));
+    }
+
+    Stripe& stripeFor(size_t hash) {
+        return stripes[hash & stripeMask];
+    }
+
+    /**
+     * @brief The bucket holding 'hash'. The caller holds the lock of the hash's stripe.
+     */
+    Node*& bucketFor(size_t hash) const {
+        Table* table = current;
+        if (next != nullptr && table->migrated[hash & table->mask]) {
+            table = next;
+        }
+        return table->buckets[hash & table->mask];
+    }
+
+    static Node* findIn(Node* head, const K& key, size_t hash) {
+        while (head != nullptr && !(head->hash == hash && head->key == key)) {
+            head = head->next;
+        }
+        return head;
+    }
+
+    static void freeChain(Node* head) {
+        while (head != nullptr) {
+            Node* nextNode = head->next;
+            delete head;
+            head = nextNode;
+        }
+    }
+
+    /**
+     * @brief Allocate a table twice the current size and publish it as the migration target.
+     * Called by the thread that won the 'resizing' flag, holding no stripe lock.
+     */
+    void startResize() {
+        // Only the flag holder replaces 'current', so it can be read without a lock here
+        size_t oldCapacity = current->buckets.size();
+        Table* target = new Table(oldCapacity * 2);
+        std::vector<uint8_t> flags(oldCapacity, 0);
+
+        lockAll();
+        current->migrated.swap(flags);
+        next = target;
+        migratedBuckets.store(0, std::memory_order_relaxed);
+        migrateCursor.store(static_cast<uint64_t>(std::countr_zero(oldCapacity) + 1) << CursorShift,
+                            std::memory_order_release);
+        unlockAll();
+    }
+
+    /**
+     * @brief Swap in the new table once every old bucket has moved, then drop the old one.
+     */
+    void finishResize() {
+        lockAll();
+        Table* old = current;
+        current = next;
+        next = nullptr;
+        migrateCursor.store(0, std::memory_order_relaxed);
+        unlockAll();
+
+        // Every chain of the old array has moved, so only the arrays themselves are freed here
+        delete old;
+        resizing.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Claim up to MigrateBuckets old buckets of the running resize, if any, and move their chains.
+     */
+    void helpResize() {
+        uint64_t word = migrateCursor.load(std::memory_order_acquire);
+        uint64_t start, end, oldCapacity;
+        do {
+            if (word == 0) {
+                return;
+            }
+            oldCapacity = uint64_t{1} << ((word >> CursorShift) - 1);
+            start = word & ((uint64_t{1} << CursorShift) - 1);
+            if (start >= oldCapacity) {
+                return;
+            }
+            end = std::min(start + MigrateBuckets, oldCapacity);
+        } while (!migrateCursor.compare_exchange_weak(word, word + (end - start), std::memory_order_acq_rel));
+
+        // The claimed buckets keep this resize from finishing, so 'current' and 'next' stay put
+        for (uint64_t i = start; i < end; i++) {
+            std::unique_lock guard(stripes[i & stripeMask].lock);
+            Node* head = current->buckets[i];
+            current->buckets[i] = nullptr;
+            Node*& low = next->buckets[i];
+            Node*& high = next->buckets[i + oldCapacity];
+            while (head != nullptr) {
+                Node* nextNode = head->next;
+                Node*& target = (head->hash & oldCapacity) ? high : low;
+                head->next = target;
+                target = head;
+                head = nextNode;
+            }
+            current->migrated[i] = 1;
+        }
+        if (migratedBuckets.fetch_add(end - start, std::memory_order_acq_rel) + (end - start) == oldCapacity) {
+            finishResize();
+        }
+    }
+
+    // Lock every stripe exclusively, in index order
+    void lockAll() {
+        for (Stripe& stripe : stripes) {
+            stripe.lock.lock();
+        }
+    }
+
+    void unlockAll() {
+        for (Stripe& stripe : stripes) {
+            stripe.lock.unlock();
+        }
+    }
+
+public:
+    /**
+     * @brief Construct an empty table.
+     *
+     * @param initialCapacity The initial number of buckets, rounded up to a power of two of at least numStripes.
+     * @param numStripes The number of lock stripes, rounded up to a power of two. Default is 64.
+     * @param loadFactorThreshold Maximum average chain length before the table doubles. Default is 0.75.
+     */
+    explicit ConcurrentHashTable(size_t initialCapacity = 64, size_t numStripes = 64, double loadFactorThreshold = 0.75)
+            : stripes(std::bit_ceil(std::max<size_t>(numStripes, 1))), stripeMask(stripes.size() - 1),
+              current(new Table(std::bit_ceil(std::max(initialCapacity, stripes.size())))), next(nullptr),
+              maxLoadFactor(loadFactorThreshold), resizing(false), migrateCursor(0), migratedBuckets(0) {}
+
+    /**
+     * @brief Destroy the table. No other thread may be using it.
+     */
+    ~ConcurrentHashTable() {
+        clear();
+        delete current;
+        delete next;
+    }
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    /**
+     * @brief Insert a key-value pair. If the key already exists, its value is updated.
+     *
+     * @return true If the key was new.
+     */
+    bool insert(const K& key, const V& value) {
+        size_t hash = hashFunction(key);
+        bool inserted = false;
+        bool overloaded = false;
+        {
+            Stripe& stripe = stripeFor(hash);
+            std::unique_lock guard(stripe.lock);
+            Node*& head = bucketFor(hash);
+            if (Node* node = findIn(head, key, hash)) {
+                node->value = value;
+            } else {
+                head = new Node(key, value, hash, head);
+                stripe.count++;
+                inserted = true;
+                overloaded = stripe.count * stripes.size() > maxLoadFactor * current->buckets.size();
+            }
+        }
+        if (overloaded && !resizing.load(std::memory_order_relaxed) && !resizing.exchange(true, std::memory_order_acquire)) {
+            startResize();
+        }
+        helpResize();
+        return inserted;
+    }
+
+    /**
+     * @brief Remove a key.
+     *
+     * @return true If the key was found and removed.
+     */
+    bool remove(const K& key) {
+        size_t hash = hashFunction(key);
+        bool removed = false;
+        {
+            Stripe& stripe = stripeFor(hash);
+            std::unique_lock guard(stripe.lock);
+            for (Node** link = &bucketFor(hash); *link != nullptr; link = &(*link)->next) {
+                Node* node = *link;
+                if (node->hash == hash && node->key == key) {
+                    *link = node->next;
+                    delete node;
+                    stripe.count--;
+                    removed = true;
+                    break;
+                }
+            }
+        }
+        helpResize();
+        return removed;
+    }
+
+    /**
+     * @brief Search for a key.
+     *
+     * @return A copy of the value if found, std::nullopt otherwise. A pointer into the table
+     * could outlive the stripe lock, so the value is copied out under it.
+     */
+    std::optional<V> search(const K& key) {
+        size_t hash = hashFunction(key);
+        std::shared_lock guard(stripeFor(hash).lock);
+        if (Node* node = findIn(bucketFor(hash), key, hash)) {
+            return node->value;
+        }
+        return std::nullopt;
+    }
+
+    bool contains(const K& key) {
+        size_t hash = hashFunction(key);
+        std::shared_lock guard(stripeFor(hash).lock);
+        return findIn(bucketFor(hash), key, hash) != nullptr;
+    }
+
+    /**
+     * @brief Number of elements. Stripes are read one at a time, so under concurrent writes this
+     * is a snapshot of each stripe, not of the whole table.
+     */
+    size_t size() {
+        size_t total = 0;
+        for (Stripe& stripe : stripes) {
+            std::shared_lock guard(stripe.lock);
+            total += stripe.count;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Remove every element, stripe by stripe. The bucket arrays keep their size.
+     */
+    void clear() {
+        for (size_t s = 0; s < stripes.size(); s++) {
+            std::unique_lock guard(stripes[s].lock);
+            for (Table* table : {current, next}) {
+                if (table == nullptr) {
+                    continue;
+                }
+                for (size_t i = s; i < table->buckets.size(); i += stripes.size()) {
+                    freeChain(table->buckets[i]);
+                    table->buckets[i] = nullptr;
+                }
+            }
+            stripes[s].count = 0;
+        }
+    }
+};
+
+/**
+ * @brief Draws ranks in [0, n) with P(rank = i) proportional to 1 / (i + 1)^theta.
+ *
+ * Uses the constant-time method of Gray et al., "Quickly Generating Billion-Record Synthetic
+ * Databases", as YCSB does. theta = 0.99 is the usual skewed key-value workload.
+ */
+class ZipfianGenerator {
+private:
+    uint64_t n;
+    double theta, alpha, zetan, eta;
+
+public:
+    ZipfianGenerator(uint64_t items, double skew) : n(items), theta(skew) {
+        double zeta2 = 1.0 + std::pow(0.5, theta);
+        zetan = 0;
+        for (uint64_t i = 1; i <= n; i++) {
+            zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+
+    template <typename Rng>
+    uint64_t operator()(Rng& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta)) {
+            return 1;
+        }
+        return std::min<uint64_t>(n - 1, static_cast<uint64_t>(n * std::pow(eta * u - eta + 1.0, alpha)));
+    }
+};
+
+// The single-threaded table behind one external mutex: what callers do today
+class MutexHashTable {
+private:
+    std::mutex lock;
+    std::unordered_map<uint64_t, uint64_t> map;
+
+public:
+    bool insert(uint64_t key, uint64_t value) {
+        std::lock_guard guard(lock);
+        return map.insert_or_assign(key, value).second;
+    }
+
+    std::optional<uint64_t> search(uint64_t key) {
+        std::lock_guard guard(lock);
+        auto it = map.find(key);
+        return it == map.end() ? std::nullopt : std::optional<uint64_t>(it->second);
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Runs totalOps Zipfian operations (writePercent% inserts, the rest searches) split over
+ * numThreads threads against a table preloaded with every key, and prints the throughput.
+ */
+template <typename Table>
+void benchmarkZipfian(const char* name, Table& table, const ZipfianGenerator& zipf, size_t totalOps,
+                      int numThreads, int writePercent) {
+    std::atomic<uint64_t> found{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rng(1000 + t);
+            uint64_t hits = 0;
+            for (size_t i = t; i < totalOps; i += numThreads) {
+                uint64_t key = zipf(rng);
+                if (static_cast<int>(rng() % 100) < writePercent) {
+                    table.insert(key, i);
+                } else if (table.search(key)) {
+                    hits++;
+                }
+            }
+            found.fetch_add(hits, std::memory_order_relaxed);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = secondsSince(start);
+    std::cout << "    " << name << totalOps / seconds / 1e6 << " Mops/s" << (found == 0 ? " " : "") << std::endl;
+}
+
+/**
+ * @brief numThreads threads insert disjoint key ranges into a table that starts with 64 buckets,
+ * so all of them take part in every resize on the way to numKeys.
+ */
+void benchmarkGrowth(size_t numKeys, int numThreads) {
+    ConcurrentHashTable<uint64_t, uint64_t> table;
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < numKeys; i += numThreads) {
+                table.insert(i, i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = secondsSince(start);
+    std::cout << "    " << numThreads << " threads: " << numKeys / seconds / 1e6 << " M inserts/s, size "
+              << table.size() << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Create a hash table with integer keys and string values
+    ConcurrentHashTable<int, std::string> hashTable;
+
+    // Test insertion
+    hashTable.insert(1, "One");
+    hashTable.insert(2, "Two");
+    hashTable.insert(3, "Three");
+    hashTable.insert(17, "Seventeen");
+
+    // Test search
+    int searchKey = 3;
+    if (std::optional<std::string> value = hashTable.search(searchKey)) {
+        std::cout << "Found key " << searchKey << " with value: " << *value << "\n";
+    } else {
+        std::cout << "Key " << searchKey << " not found.\n";
+    }
+
+    // Test removal
+    int removeKey = 2;
+    std::cout << "Key " << removeKey << (hashTable.remove(removeKey) ? " removed successfully.\n" : " not found.\n");
+
+    // Test contains
+    int checkKey = 17;
+    std::cout << "Hash Table Table contains key " << checkKey << ": "
+              << (hashTable.contains(checkKey) ? "Yes" : "No") << "\n";
+    std::cout << "Current size: " << hashTable.size() << "\n";
+
+    // Test clear
+    hashTable.clear();
+    std::cout << "Hash Table Table cleared.\n";
+    std::cout << "Current size: " << hashTable.size() << "\n";
+
+    // Pass "full" for 10x the operations
+    bool full = argc > 1 && std::string(argv[1]) == "full";
+    size_t numKeys = 1'000'000;
+    size_t totalOps = full ? 40'000'000 : 4'000'000;
+    std::cout << "\nThreads on this machine: " << std::thread::hardware_concurrency() << std::endl;
+
+    ZipfianGenerator zipf(numKeys, 0.99);
+    ConcurrentHashTable<uint64_t, uint64_t> striped;
+    MutexHashTable locked;
+    for (uint64_t key = 0; key < numKeys; key++) {
+        striped.insert(key, key);
+        locked.insert(key, key);
+    }
+    for (int writePercent : {5, 50}) {
+        std::cout << "\nZipfian (theta 0.99) over " << numKeys << " keys, " << writePercent << "% inserts, "
+                  << totalOps << " operations" << std::endl;
+        for (int numThreads : {1, 2, 4, 8, 16, 32, 64}) {
+            std::cout << "  " << numThreads << " threads" << std::endl;
+            benchmarkZipfian("64 striped rwlocks: ", striped, zipf, totalOps, numThreads, writePercent);
+            benchmarkZipfian("one mutex:          ", locked, zipf, totalOps, numThreads, writePercent);
+        }
+    }
+
+    std::cout << "\nConcurrent inserts from 64 buckets to " << numKeys * 4 << " keys (cooperative resize)" << std::endl;
+    for (int numThreads : {1, 4, 16, 64}) {
+        benchmarkGrowth(numKeys * 4, numThreads);
+    }
+
+    return 0;
+}
@@ -1,3 +1,721 @@
 //
 // Created by liadp on 12/31/2024.
 //
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "../../Challanges/Data Structures/Tree/t_ch_7/btree.h"
+
+using namespace std;
+
+/*
+ * B+Tree
+ *
+ * A B-Tree keeps a value next to every key, in internal nodes as well as in leaves. A B+Tree
+ * splits the two jobs:
+ *
+ * - Leaves hold all the (key, value) pairs, and are linked to their neighbours in both
+ *   directions, so the leaf level on its own is a sorted list of every pair.
+ * - Internal nodes hold only separator keys and child pointers. A separator is a copy of the
+ *   first key of the leaf to its right (keys >= separator go right), so no value sits there.
+ *
+ *                      [ 20 | 40 ]
+ *            /              |              \
+ *   [5 10 15] <-> [20 25 30 35] <-> [40 45 50]
+ *
+ * Because internal nodes carry no values they fit more children in the same bytes (higher
+ * fanout, so a shallower tree), and a range scan finds its first key once and then walks along
+ * the leaves without ever going back up.
+ *
+ * Keys are unique: inserting a key that is already there replaces its value.
+ */
+
+/**
+ * @brief BPlusTree class
+ *
+ * Every node (internal or leaf) holds between t - 1 and 2t - 1 keys, except the root.
+ */
+template <typename K, typename V>
+class BPlusTree {
+private:
+    static constexpr size_t CacheLine = 64;
+
+    /**
+     * @brief Header shared by both node kinds. Each node is one block: the header, then its arrays.
+     */
+    struct Node {
+        bool isLeaf;
+        int numKeys;
+        K* keys;
+    };
+
+    /**
+     * @brief [ header | separator keys (2t - 1) | children (2t) ]
+     */
+    struct InternalNode : Node {
+        Node** children;
+    };
+
+    /**
+     * @brief [ header | keys (2t - 1) | values (2t - 1) ], linked to the leaves on both sides.
+     */
+    struct LeafNode : Node {
+        V* values;
+        LeafNode* prev;
+        LeafNode* next;
+    };
+
+    Node* root;
+    LeafNode* head;   // Leftmost leaf
+    LeafNode* tail;   // Rightmost leaf
+    int t;
+    size_t count;
+
+    // Byte offsets of the arrays inside each kind of node block, computed once from 't'
+    size_t internalKeysOffset;
+    size_t childrenOffset;
+    size_t internalBytes;
+    size_t leafKeysOffset;
+    size_t valuesOffset;
+    size_t leafBytes;
+
+    static size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    static InternalNode* asInternal(Node* node) {
+        return static_cast<InternalNode*>(node);
+    }
+
+    static LeafNode* asLeaf(Node* node) {
+        return static_cast<LeafNode*>(node);
+    }
+
+    InternalNode* createInternal() {
+        char* block = static_cast<char*>(::operator new(internalBytes, align_val_t(CacheLine)));
+        InternalNode* node = new (block) InternalNode;
+        node->isLeaf = false;
+        node->numKeys = 0;
+        node->keys = reinterpret_cast<K*>(block + internalKeysOffset);
+        node->children = reinterpret_cast<Node**>(block + childrenOffset);
+        uninitialized_default_construct_n(node->keys, 2 * t - 1);
+        uninitialized_value_construct_n(node->children, 2 * t);
+        return node;
+    }
+
+    LeafNode* createLeaf() {
+        char* block = static_cast<char*>(::operator new(leafBytes, align_val_t(CacheLine)));
+        LeafNode* node = new (block) LeafNode;
+        node->isLeaf = true;
+        node->numKeys = 0;
+        node->keys = reinterpret_cast<K*>(block + leafKeysOffset);
+        node->values = reinterpret_cast<V*>(block + valuesOffset);
+        node->prev = nullptr;
+        node->next = nullptr;
+        uninitialized_default_construct_n(node->keys, 2 * t - 1);
+        uninitialized_default_construct_n(node->values, 2 * t - 1);
+        return node;
+    }
+
+    void destroyNode(Node* node) {
+        destroy_n(node->keys, 2 * t - 1);
+        if (node->isLeaf) {
+            destroy_n(asLeaf(node)->values, 2 * t - 1);
+            asLeaf(node)->~LeafNode();
+        } else {
+            asInternal(node)->~InternalNode();
+        }
+        ::operator delete(static_cast<void*>(node), align_val_t(CacheLine));
+    }
+
+    void clearSubtree(Node* node) {
+        if (node == nullptr) {
+            return;
+        }
+        if (!node->isLeaf) {
+            for (int i = 0; i <= node->numKeys; i++) {
+                clearSubtree(asInternal(node)->children[i]);
+            }
+        }
+        destroyNode(node);
+    }
+
+    /**
+     * @brief Puts 'separator' and the new right child 'right' into 'parent' at slot 'index'.
+     */
+    static void insertSeparator(InternalNode* parent, int index, const K& separator, Node* right) {
+        int n = parent->numKeys;
+        move_backward(parent->keys + index, parent->keys + n, parent->keys + n + 1);
+        copy_backward(parent->children + index + 1, parent->children + n + 1, parent->children + n + 2);
+        parent->keys[index] = separator;
+        parent->children[index + 1] = right;
+        parent->numKeys++;
+    }
+
+    /**
+     * @brief Splits the full child at 'childIndex' of 'parent'.
+     *
+     * A full leaf keeps its first t pairs, the last t - 1 go to a new leaf linked in after it,
+     * and a *copy* of the new leaf's first key becomes the separator. A full internal node
+     * splits like a B-Tree node: its middle key moves up.
+     */
+    void splitChild(InternalNode* parent, int childIndex) {
+        Node* child = parent->children[childIndex];
+
+        if (child->isLeaf) {
+            LeafNode* left = asLeaf(child);
+            LeafNode* right = createLeaf();
+            move(left->keys + t, left->keys + 2 * t - 1, right->keys);
+            move(left->values + t, left->values + 2 * t - 1, right->values);
+            right->numKeys = t - 1;
+            left->numKeys = t;
+
+            right->prev = left;
+            right->next = left->next;
+            if (left->next != nullptr) {
+                left->next->prev = right;
+            } else {
+                tail = right;
+            }
+            left->next = right;
+
+            insertSeparator(parent, childIndex, right->keys[0], right);
+        } else {
+            InternalNode* left = asInternal(child);
+            InternalNode* right = createInternal();
+            int mid = t - 1;
+            move(left->keys + t, left->keys + 2 * t - 1, right->keys);
+            copy(left->children + t, left->children + 2 * t, right->children);
+            right->numKeys = t - 1;
+            left->numKeys = mid;
+
+            insertSeparator(parent, childIndex, left->keys[mid], right);
+        }
+    }
+
+    /**
+     * @brief The leaf whose key range contains 'key'.
+     */
+    LeafNode* findLeaf(const K& key) const {
+        Node* node = root;
+        while (!node->isLeaf) {
+            int i = KeyRank<K>::upper(node->keys, node->numKeys, key);
+            node = asInternal(node)->children[i];
+        }
+        return asLeaf(node);
+    }
+
+    // --- Removal helpers: children[i] of 'parent' fell below t - 1 keys ---
+
+    void borrowFromLeft(InternalNode* parent, int i) {
+        Node* child = parent->children[i];
+        Node* left = parent->children[i - 1];
+        move_backward(child->keys, child->keys + child->numKeys, child->keys + child->numKeys + 1);
+
+        if (child->isLeaf) {
+            // Take the left leaf's last pair; the separator becomes the child's new first key
+            LeafNode* leaf = asLeaf(child);
+            move_backward(leaf->values, leaf->values + leaf->numKeys, leaf->values + leaf->numKeys + 1);
+            leaf->keys[0] = std::move(left->keys[left->numKeys - 1]);
+            leaf->values[0] = std::move(asLeaf(left)->values[left->numKeys - 1]);
+            parent->keys[i - 1] = leaf->keys[0];
+        } else {
+            // Rotate through the parent, as in a B-Tree
+            InternalNode* node = asInternal(child);
+            copy_backward(node->children, node->children + node->numKeys + 1, node->children + node->numKeys + 2);
+            node->keys[0] = std::move(parent->keys[i - 1]);
+            node->children[0] = asInternal(left)->children[left->numKeys];
+            parent->keys[i - 1] = std::move(left->keys[left->numKeys - 1]);
+        }
+        child->numKeys++;
+        left->numKeys--;
+    }
+
+    void borrowFromRight(InternalNode* parent, int i) {
+        Node* child = parent->children[i];
+        Node* right = parent->children[i + 1];
+
+        if (child->isLeaf) {
+            // Take the right leaf's first pair; its next key becomes the separator
+            LeafNode* leaf = asLeaf(child);
+            LeafNode* rightLeaf = asLeaf(right);
+            leaf->keys[leaf->numKeys] = std::move(rightLeaf->keys[0]);
+            leaf->values[leaf->numKeys] = std::move(rightLeaf->values[0]);
+            move(rightLeaf->keys + 1, rightLeaf->keys + rightLeaf->numKeys, rightLeaf->keys);
+            move(rightLeaf->values + 1, rightLeaf->values + rightLeaf->numKeys, rightLeaf->values);
+            parent->keys[i] = rightLeaf->keys[0];
+        } else {
+            InternalNode* node = asInternal(child);
+            InternalNode* rightNode = asInternal(right);
+            node->keys[node->numKeys] = std::move(parent->keys[i]);
+            node->children[node->numKeys + 1] = rightNode->children[0];
+            parent->keys[i] = std::move(rightNode->keys[0]);
+            move(rightNode->keys + 1, rightNode->keys + rightNode->numKeys, rightNode->keys);
+            copy(rightNode->children + 1, rightNode->children + rightNode->numKeys + 1, rightNode->children);
+        }
+        child->numKeys++;
+        right->numKeys--;
+    }
+
+    /**
+     * @brief Merges children[i + 1] into children[i] and drops separator i from 'parent'.
+     */
+    void mergeChildren(InternalNode* parent, int i) {
+        Node* left = parent->children[i];
+        Node* right = parent->children[i + 1];
+
+        if (left->isLeaf) {
+            // Leaves just concatenate; the separator was only a copy
+            LeafNode* leftLeaf = asLeaf(left);
+            LeafNode* rightLeaf = asLeaf(right);
+            move(rightLeaf->keys, rightLeaf->keys + rightLeaf->numKeys, leftLeaf->keys + leftLeaf->numKeys);
+            move(rightLeaf->values, rightLeaf->values + rightLeaf->numKeys, leftLeaf->values + leftLeaf->numKeys);
+            leftLeaf->numKeys += rightLeaf->numKeys;
+
+            leftLeaf->next = rightLeaf->next;
+            if (rightLeaf->next != nullptr) {
+                rightLeaf->next->prev = leftLeaf;
+            } else {
+                tail = leftLeaf;
+            }
+        } else {
+            // Internal nodes pull the separator down between the two halves
+            InternalNode* leftNode = asInternal(left);
+            InternalNode* rightNode = asInternal(right);
+            leftNode->keys[leftNode->numKeys] = std::move(parent->keys[i]);
+            move(rightNode->keys, rightNode->keys + rightNode->numKeys, leftNode->keys + leftNode->numKeys + 1);
+            copy(rightNode->children, rightNode->children + rightNode->numKeys + 1,
+                 leftNode->children + leftNode->numKeys + 1);
+            leftNode->numKeys += rightNode->numKeys + 1;
+        }
+
+        move(parent->keys + i + 1, parent->keys + parent->numKeys, parent->keys + i);
+        copy(parent->children + i + 2, parent->children + parent->numKeys + 1, parent->children + i + 1);
+        parent->numKeys--;
+        destroyNode(right);
+    }
+
+public:
+    /**
+     * @brief Position of one (key, value) pair in the leaf chain, usable in both directions.
+     *
+     * Moving to the next pair is an index increment, or one hop to the next leaf: range scans
+     * never go back up the tree. Invalidated by insert(), remove() and clear(). Decrementing
+     * begin() gives end(), and decrementing end() gives the last pair (end() if the tree is empty).
+     */
+    class Iterator {
+    private:
+        friend class BPlusTree;
+
+        const BPlusTree* tree;
+        LeafNode* leaf;    // nullptr means end()
+        int index;
+
+        Iterator(const BPlusTree* tree, LeafNode* leaf, int index) : tree(tree), leaf(leaf), index(index) {}
+
+    public:
+        bool valid() const {
+            return leaf != nullptr;
+        }
+
+        const K& key() const {
+            return leaf->keys[index];
+        }
+
+        V& value() const {
+            return leaf->values[index];
+        }
+
+        pair<const K&, V&> operator*() const {
+            return {leaf->keys[index], leaf->values[index]};
+        }
+
+        Iterator& operator++() {
+            if (++index == leaf->numKeys) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Iterator& operator--() {
+            if (leaf == nullptr || index == 0) {
+                // From end() wrap to the last leaf, from a leaf's first pair step to the previous leaf
+                leaf = leaf == nullptr ? tree->tail : leaf->prev;
+                index = leaf == nullptr ? 0 : leaf->numKeys - 1;
+            } else {
+                index--;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return leaf == other.leaf && index == other.index;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * @brief Constructor for BPlusTree.
+     *
+     * @param t The minimum degree. Every node holds up to 2t - 1 keys; internal nodes have up to 2t children.
+     */
+    BPlusTree(int t)
+            : root(nullptr), head(nullptr), tail(nullptr), t(t), count(0),
+              internalKeysOffset(alignUp(sizeof(InternalNode), alignof(K))),
+              childrenOffset(alignUp(internalKeysOffset + (2 * t - 1) * sizeof(K), alignof(Node*))),
+              internalBytes(alignUp(childrenOffset + 2 * t * sizeof(Node*), CacheLine)),
+              leafKeysOffset(alignUp(sizeof(LeafNode), alignof(K))),
+              valuesOffset(alignUp(leafKeysOffset + (2 * t - 1) * sizeof(K), alignof(V))),
+              leafBytes(alignUp(valuesOffset + (2 * t - 1) * sizeof(V), CacheLine)) {}
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    ~BPlusTree() {
+        clear();
+    }
+
+    /**
+     * @brief Insert a key-value pair, or replace the value if the key is already there.
+     *
+     * Same top-down walk as the B-Tree: a full root is split first, and every full child is
+     * split before the walk enters it, so the leaf that gets the pair always has room.
+     *
+     * @return bool True if the key was new, false if an existing value was replaced.
+     */
+    bool insert(const K& key, const V& value) {
+        if (root == nullptr) {
+            head = tail = createLeaf();
+            root = head;
+        }
+        if (root->numKeys == 2 * t - 1) {
+            InternalNode* newRoot = createInternal();
+            newRoot->children[0] = root;
+            root = newRoot;
+            splitChild(newRoot, 0);
+        }
+
+        Node* node = root;
+        while (!node->isLeaf) {
+            InternalNode* internal = asInternal(node);
+            int i = KeyRank<K>::upper(internal->keys, internal->numKeys, key);
+            if (internal->children[i]->numKeys == 2 * t - 1) {
+                splitChild(internal, i);
+                if (!(key < internal->keys[i])) {
+                    i++;
+                }
+            }
+            node = internal->children[i];
+        }
+
+        LeafNode* leaf = asLeaf(node);
+        int pos = KeyRank<K>::lower(leaf->keys, leaf->numKeys, key);
+        if (pos < leaf->numKeys && !(key < leaf->keys[pos])) {
+            leaf->values[pos] = value;
+            return false;
+        }
+        move_backward(leaf->keys + pos, leaf->keys + leaf->numKeys, leaf->keys + leaf->numKeys + 1);
+        move_backward(leaf->values + pos, leaf->values + leaf->numKeys, leaf->values + leaf->numKeys + 1);
+        leaf->keys[pos] = key;
+        leaf->values[pos] = value;
+        leaf->numKeys++;
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Look up the value stored for a key.
+     *
+     * @return V* Pointer to the value, or nullptr if the key is not in the tree.
+     */
+    V* find(const K& key) const {
+        if (root == nullptr) {
+            return nullptr;
+        }
+        LeafNode* leaf = findLeaf(key);
+        int pos = KeyRank<K>::lower(leaf->keys, leaf->numKeys, key);
+        if (pos < leaf->numKeys && !(key < leaf->keys[pos])) {
+            return &leaf->values[pos];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Search for a key in the B+Tree.
+     */
+    bool search(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Remove a key from the B+Tree.
+     *
+     * The pair is deleted from its leaf, then underflow is fixed bottom-up along the path:
+     * a node with fewer than t - 1 keys borrows from a sibling that can spare one, or merges
+     * with it. Separators are left alone when a leaf's first key goes away; they still split
+     * the two ranges correctly.
+     *
+     * @return bool True if the key was found and removed.
+     */
+    bool remove(const K& key) {
+        if (root == nullptr) {
+            return false;
+        }
+
+        // A B+Tree with fewer than 2^63 keys is never deeper than this
+        InternalNode* path[64];
+        int childIndex[64];
+        int depth = 0;
+
+        Node* node = root;
+        while (!node->isLeaf) {
+            int i = KeyRank<K>::upper(node->keys, node->numKeys, key);
+            path[depth] = asInternal(node);
+            childIndex[depth] = i;
+            depth++;
+            node = asInternal(node)->children[i];
+        }
+
+        LeafNode* leaf = asLeaf(node);
+        int pos = KeyRank<K>::lower(leaf->keys, leaf->numKeys, key);
+        if (pos == leaf->numKeys || key < leaf->keys[pos]) {
+            return false;
+        }
+        move(leaf->keys + pos + 1, leaf->keys + leaf->numKeys, leaf->keys + pos);
+        move(leaf->values + pos + 1, leaf->values + leaf->numKeys, leaf->values + pos);
+        leaf->numKeys--;
+        count--;
+
+        // Walk back up while the node just changed is short of keys
+        for (int d = depth - 1; d >= 0; d--) {
+            InternalNode* parent = path[d];
+            int i = childIndex[d];
+            if (parent->children[i]->numKeys >= t - 1) {
+                break;
+            }
+            if (i > 0 && parent->children[i - 1]->numKeys > t - 1) {
+                borrowFromLeft(parent, i);
+            } else if (i < parent->numKeys && parent->children[i + 1]->numKeys > t - 1) {
+                borrowFromRight(parent, i);
+            } else if (i < parent->numKeys) {
+                mergeChildren(parent, i);
+            } else {
+                mergeChildren(parent, i - 1);
+            }
+        }
+
+        // An empty internal root hands over to its only child; an empty leaf root means an empty tree
+        if (root->numKeys == 0) {
+            Node* oldRoot = root;
+            if (root->isLeaf) {
+                root = nullptr;
+                head = tail = nullptr;
+            } else {
+                root = asInternal(root)->children[0];
+            }
+            destroyNode(oldRoot);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Iterator at the smallest key, or end() if the tree is empty.
+     */
+    Iterator begin() const {
+        return Iterator(this, head, 0);
+    }
+
+    /**
+     * @brief Iterator one past the largest key.
+     */
+    Iterator end() const {
+        return Iterator(this, nullptr, 0);
+    }
+
+    /**
+     * @brief Iterator at the first key that is not less than 'key', or end() if there is none.
+     */
+    Iterator lower_bound(const K& key) const {
+        if (root == nullptr) {
+            return end();
+        }
+        LeafNode* leaf = findLeaf(key);
+        int pos = KeyRank<K>::lower(leaf->keys, leaf->numKeys, key);
+        if (pos == leaf->numKeys) {
+            // Everything in this leaf is smaller, so the answer is the next leaf's first key
+            return Iterator(this, leaf->next, 0);
+        }
+        return Iterator(this, leaf, pos);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Number of levels in the tree (0 when empty, 1 when the root is a leaf).
+     */
+    int height() const {
+        int levels = 0;
+        for (Node* node = root; node != nullptr; node = node->isLeaf ? nullptr : asInternal(node)->children[0]) {
+            levels++;
+        }
+        return levels;
+    }
+
+    /**
+     * @brief Print the keys in sorted order by walking the leaf chain.
+     */
+    void printInOrder() const {
+        for (LeafNode* leaf = head; leaf != nullptr; leaf = leaf->next) {
+            for (int i = 0; i < leaf->numKeys; i++) {
+                cout << leaf->keys[i] << " ";
+            }
+        }
+        cout << endl;
+    }
+
+    /**
+     * @brief Remove all nodes from the B+Tree, making it empty.
+     */
+    void clear() {
+        clearSubtree(root);
+        root = nullptr;
+        head = tail = nullptr;
+        count = 0;
+    }
+};
+
+// --- Benchmark ---
+
+/**
+ * @brief splitmix64 finalizer, a bijection on 64-bit integers (distinct keys in random order).
+ */
+static uint64_t mixKey(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static double nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Inserts, point lookups and 1000-key range scans: t_ch_7 BTree vs BPlusTree.
+ *
+ * The degrees give both trees the same node size in bytes for 8-byte keys and values
+ * (BTree t = 32: 63 keys + 63 values + 64 children; BPlusTree t = 48: 95 keys + 96 children
+ * per internal node, 95 pairs per leaf), so the B+Tree's extra fanout comes from leaving the
+ * values out of its internal nodes.
+ */
+void benchmarkAgainstBTree(size_t numKeys) {
+    const int btreeDegree = 32;
+    const int bplusDegree = 48;
+    cout << numKeys << " random keys, BTree t = " << btreeDegree << ", BPlusTree t = " << bplusDegree << endl;
+
+    BTree<uint64_t, uint64_t> btree(btreeDegree);
+    BPlusTree<uint64_t, uint64_t> bplus(bplusDegree);
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        btree.insert(mixKey(i), i);
+    }
+    double btreeInsert = nanosSince(start) / numKeys;
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        bplus.insert(mixKey(i), i);
+    }
+    double bplusInsert = nanosSince(start) / numKeys;
+    cout << "  insert:      BTree " << btreeInsert << " ns, BPlusTree " << bplusInsert << " ns (height "
+         << btree.height() << " vs " << bplus.height() << ")" << endl;
+
+    const size_t numLookups = 1'000'000;
+    mt19937_64 rng(17);
+    vector<uint64_t> probes(numLookups);
+    for (uint64_t& probe : probes) {
+        probe = mixKey(rng() % numKeys);
+    }
+
+    uint64_t sum = 0;
+    start = chrono::steady_clock::now();
+    for (uint64_t probe : probes) {
+        sum += *btree.find(probe);
+    }
+    double btreeLookup = nanosSince(start) / numLookups;
+
+    start = chrono::steady_clock::now();
+    for (uint64_t probe : probes) {
+        sum -= *bplus.find(probe);
+    }
+    double bplusLookup = nanosSince(start) / numLookups;
+    cout << "  lookup:      BTree " << btreeLookup << " ns, BPlusTree " << bplusLookup << " ns"
+         << (sum == 0 ? "" : " (mismatch)") << endl;
+
+    const size_t numScans = 10'000;
+    const int scanLength = 1000;
+    start = chrono::steady_clock::now();
+    for (size_t s = 0; s < numScans; s++) {
+        auto cursor = btree.lower_bound(probes[s]);
+        for (int i = 0; i < scanLength && cursor.valid(); i++, ++cursor) {
+            sum += cursor.value();
+        }
+    }
+    double btreeScan = nanosSince(start) / (numScans * scanLength);
+
+    start = chrono::steady_clock::now();
+    for (size_t s = 0; s < numScans; s++) {
+        auto it = bplus.lower_bound(probes[s]);
+        for (int i = 0; i < scanLength && it.valid(); i++, ++it) {
+            sum -= it.value();
+        }
+    }
+    double bplusScan = nanosSince(start) / (numScans * scanLength);
+    cout << "  1k-key scan: BTree " << btreeScan << " ns/key, BPlusTree " << bplusScan << " ns/key"
+         << (sum == 0 ? "" : " (mismatch)") << endl;
+}
+
+int main(int argc, char* argv[]) {
+    BPlusTree<int, string> tree(2);
+    for (int key : {10, 20, 5, 6, 12, 30, 7, 17}) {
+        tree.insert(key, to_string(key));
+    }
+    tree.printInOrder();
+
+    cout << "Keys from 7 to 20:";
+    for (auto it = tree.lower_bound(7); it.valid() && it.key() <= 20; ++it) {
+        cout << " " << it.key();
+    }
+    cout << endl;
+
+    tree.remove(6);
+    tree.remove(20);
+    cout << "After removing 6 and 20: ";
+    tree.printInOrder();
+
+    if (string* value = tree.find(12)) {
+        cout << "12 found with value " << *value << endl;
+    }
+
+    // Pass "full" for a tree much larger than the caches
+    bool full = argc > 1 && string(argv[1]) == "full";
+    benchmarkAgainstBTree(1'000'000);
+    if (full) {
+        benchmarkAgainstBTree(50'000'000);
+    }
+
+    return 0;
+}
@@ -2,29 +2,59 @@
 #include <vector>
 #include <list>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <stdexcept>
 #include <cstdlib>
 #include <ctime>
 
 using namespace std;
 
+/**
+ * @brief Transparent hash for string keys.
+ *
+ * Hashes string, string_view and const char* identically, so a table keyed by string can be
+ * searched with a string_view slice or a literal without building a temporary string.
+ */
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(string_view key) const { return hash<string_view>{}(key); }
+    size_t operator()(const string& key) const { return hash<string_view>{}(key); }
+    size_t operator()(const char* key) const { return hash<string_view>{}(key); }
+};
+
 /**
  * @brief HashTable class
  *
  * This class provides a skeleton for a generic hash table.
  * It uses separate chaining to handle collisions.
+ *
+ * When both Hash and KeyEqual declare is_transparent (e.g. StringHash and equal_to<>), find()
+ * and remove() also accept any type they can hash and compare against K, in the same way as
+ * C++20 heterogeneous lookup in unordered_map.
  */
-template <typename K, typename V>
+template <typename K, typename V, typename Hash = function<size_t(const K&)>,
+          typename KeyEqual = equal_to<K>>
 class HashTable {
 protected:
     // A single bucket in the hash table
     struct Bucket {
         K key;
         V value;
+        size_t hash;  // Full hashFunc(key), kept so rehash() never calls hashFunc again
 
-        Bucket(K k, V v) : key(k), value(v) {}
+        Bucket(K k, V v, size_t h) : key(std::move(k)), value(std::move(v)), hash(h) {}
     };
 
+    // Lookups with a type other than K are only allowed through a transparent Hash and KeyEqual
+    static constexpr bool isTransparent =
+        requires { typename Hash::is_transparent; } && requires { typename KeyEqual::is_transparent; };
+
+    // A std::function hash is empty when default-constructed, so it has to be passed in
+    static constexpr bool needsHashArgument = is_same_v<Hash, function<size_t(const K&)>>;
+
     // Vector of lists (buckets) to store key-value pairs
     vector<list<Bucket>> table;
 
@@ -32,7 +62,42 @@ protected:
     size_t tableSize;
 
     // Hash Table function
-    function<size_t(const K&)> hashFunc;
+    Hash hashFunc;
+
+    // Key comparison
+    KeyEqual keyEqual;
+
+    // Returns the entry holding key in the list at hash % tableSize, or end() of that list
+    template <typename Q>
+    auto locate(const Q& key, size_t hash) const {
+        const auto& bucketList = table[hash % tableSize];
+        auto it = bucketList.begin();
+        while (it != bucketList.end() && !(it->hash == hash && keyEqual(it->key, key))) {
+            ++it;
+        }
+        return it;
+    }
+
+    template <typename Q>
+    void removeKey(const Q& key) {
+        size_t hash = hashFunc(key);
+        auto it = locate(key, hash);
+        auto& bucketList = table[hash % tableSize];
+        if (it == bucketList.end()) {
+            throw runtime_error("Key not found");
+        }
+        bucketList.erase(it);
+    }
+
+    template <typename Q>
+    V findKey(const Q& key) const {
+        size_t hash = hashFunc(key);
+        auto it = locate(key, hash);
+        if (it == table[hash % tableSize].end()) {
+            throw runtime_error("Key not found");
+        }
+        return it->value;
+    }
 
 public:
     /**
@@ -40,8 +105,17 @@ public:
      * @param size Initial size of the table.
      * @param hashFunction Custom hash function.
      */
-    HashTable(size_t size, function<size_t(const K&)> hashFunction)
-            : table(size), tableSize(size), hashFunc(hashFunction) {}
+    HashTable(size_t size, Hash hashFunction, KeyEqual equal = KeyEqual())
+            : table(size), tableSize(size), hashFunc(std::move(hashFunction)), keyEqual(std::move(equal)) {}
+
+    /**
+     * @brief Construct a new HashTable with a given size and a default-constructed Hash.
+     *
+     * Only available for a Hash other than the default std::function, which would be empty.
+     * @param size Initial size of the table.
+     */
+    explicit HashTable(size_t size) requires (!needsHashArgument)
+            : table(size), tableSize(size), hashFunc(), keyEqual() {}
 
 
     /**
@@ -56,8 +130,7 @@ public:
      */
     void insert(const K& key, const V& value) {
         size_t hash = hashFunc(key);
-        Bucket new_bucket = Bucket(key, value);
-        table[hash].emplace_back(new_bucket);
+        table[hash % tableSize].emplace_back(key, value, hash);
     }
 
     /**
@@ -65,15 +138,16 @@ public:
      * @param key The key to remove.
      */
     void remove(const K& key) {
-        size_t hash = hashFunc(key) % tableSize;
-        auto& bucketList = table[hash];
-        for (auto it = bucketList.begin(); it != bucketList.end(); ++it) {
-            if (it->key == key) {
-                bucketList.erase(it);
-                return;
-            }
-        }
-        throw runtime_error("Key not found");
+        removeKey(key);
+    }
+
+    /**
+     * @brief Remove a key given as any type a transparent Hash/KeyEqual accepts.
+     * @param key The key to remove.
+     */
+    template <typename Q> requires isTransparent
+    void remove(const Q& key) {
+        removeKey(key);
     }
 
 /**
@@ -82,14 +156,36 @@ public:
  * @return The value associated with the key.
  */
     V find(const K& key) const {
-        size_t hash = hashFunc(key) % tableSize;
-        const auto& bucketList = table[hash];
-        for (const auto& bucket : bucketList) {
-            if (bucket.key == key) {
-                return bucket.value;
+        return findKey(key);
+    }
+
+    /**
+     * @brief Find a key given as any type a transparent Hash/KeyEqual accepts.
+     * @param key The key to search for.
+     * @return The value associated with the key.
+     */
+    template <typename Q> requires isTransparent
+    V find(const Q& key) const {
+        return findKey(key);
+    }
+
+    /**
+     * @brief Change the number of bucket lists.
+     *
+     * Entries are spliced into their new lists by their stored hash, so no key is hashed again
+     * and no entry is copied or reallocated.
+     * @param newSize The new number of bucket lists.
+     */
+    void rehash(size_t newSize) {
+        vector<list<Bucket>> newTable(newSize);
+        for (auto& bucketList : table) {
+            while (!bucketList.empty()) {
+                auto& target = newTable[bucketList.front().hash % newSize];
+                target.splice(target.end(), bucketList, bucketList.begin());
             }
         }
-        throw runtime_error("Key not found");
+        table.swap(newTable);
+        tableSize = newSize;
     }
 
 /**
@@ -131,6 +227,18 @@ int main() {
     cout << "Test case: Removing a key..." << endl;
     hashTable.remove(11);
 
+    // Test case: String keys looked up through string_view and const char* without a temporary string
+    cout << "Test case: Transparent string lookup..." << endl;
+    HashTable<string, int, StringHash, equal_to<>> wordTable(8);
+    wordTable.insert("apple", 1);
+    wordTable.insert("banana", 2);
+    string_view buffer = "GET banana HTTP/1.1";
+    cout << "Key banana: " << wordTable.find(buffer.substr(4, 6)) << endl;
+    cout << "Key apple: " << wordTable.find("apple") << endl;
+    wordTable.rehash(32);
+    cout << "Key banana after rehash: " << wordTable.find(string("banana")) << endl;
+    wordTable.remove("apple");
+
     // Test case: Clear the hash table
     cout << "Test case: Clearing the hash table..." << endl;
     hashTable.clear();
@@ -0,0 +1,509 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "btree.h"
+
+/*
+ * B-epsilon tree (buffered B-Tree)
+ *
+ * BTree::insert walks from the root to a leaf and writes the key into that leaf right away.
+ * With random keys and a tree much bigger than the caches, nearly every insert pays a cache
+ * miss (or, on disk, a page read) at the bottom levels, just to add 16 bytes.
+ *
+ * A B-epsilon tree gives every internal node a message buffer:
+ *
+ *              [ pivots | buffer: (k, insert v) (k', delete) ... ]
+ *             /         |         \
+ *          child      child      child
+ *
+ * - insert() and remove() do not walk anywhere. They append a message to a small log at the
+ *   root, which is sorted and merged into the root's buffer every PendingCapacity messages.
+ * - When a buffer passes its capacity it is flushed: its messages are already sorted, so they
+ *   split into one run per child, and each run is merged into the child's buffer (or, for a
+ *   leaf, applied to its pairs). A flush moves many messages into a child with one visit, so
+ *   the cost of touching that child is shared by all of them.
+ * - A child that grew too big after a flush is split, just like in a B-Tree.
+ *
+ * A key may have messages at several levels; the one higher up is always newer, because
+ * messages only ever move down. So find() walks root to leaf and stops at the first message
+ * or leaf pair for the key it meets. Each buffer holds at most one message per key (a newer
+ * message replaces the older one when buffers merge), so a buffer lookup is a binary search.
+ *
+ * Values live only in the leaves, as in a B+Tree. Keys are unique: inserting an existing key
+ * replaces its value. Deletes are blind (the caller does not learn whether the key was
+ * there), and leaves emptied by deletes are not merged back together.
+ */
+
+using namespace std;
+
+/**
+ * @brief Write-optimized B-Tree that buffers inserts and deletes in its internal nodes.
+ */
+template <typename K, typename V>
+class BETree {
+private:
+    /**
+     * @brief A pending change for one key: set it to 'value', or delete it.
+     */
+    struct Message {
+        K key;
+        V value;
+        bool isDelete;
+    };
+
+    struct Node {
+        bool isLeaf;
+        vector<K> keys;          // Leaf: the keys. Internal: the pivots, children.size() - 1 of them
+        vector<V> values;        // Leaf only, parallel to keys
+        vector<Node*> children;  // Internal only; keys >= pivots[i] go to children[i + 1]
+        vector<Message> buffer;  // Internal only, sorted by key, at most one message per key
+
+        explicit Node(bool leaf) : isLeaf(leaf) {}
+    };
+
+    // Messages collected at the root before they are sorted into its buffer
+    static constexpr size_t PendingCapacity = 64;
+
+    Node* root;
+    vector<Message> pending;   // Arrival order
+    size_t leafCapacity;
+    size_t maxFanout;
+    size_t bufferCapacity;
+
+    static bool keyLess(const Message& a, const Message& b) {
+        return a.key < b.key;
+    }
+
+    static size_t childIndex(const Node* node, const K& key) {
+        return KeyRank<K>::upper(node->keys.data(), int(node->keys.size()), key);
+    }
+
+    bool overfull(const Node* node) const {
+        return node->isLeaf ? node->keys.size() > leafCapacity : node->children.size() > maxFanout;
+    }
+
+    /**
+     * @brief Merges two sorted, duplicate-free message runs. On a tie the newer message wins.
+     */
+    static vector<Message> mergeMessages(vector<Message>& older, Message* newer, Message* newerEnd) {
+        vector<Message> merged;
+        merged.reserve(older.size() + (newerEnd - newer));
+        auto it = older.begin();
+        while (it != older.end() && newer != newerEnd) {
+            if (it->key < newer->key) {
+                merged.push_back(std::move(*it++));
+            } else {
+                if (!(newer->key < it->key)) {
+                    ++it;   // Same key: the newer message replaces it
+                }
+                merged.push_back(std::move(*newer++));
+            }
+        }
+        move(it, older.end(), back_inserter(merged));
+        move(newer, newerEnd, back_inserter(merged));
+        return merged;
+    }
+
+    /**
+     * @brief Applies a sorted, duplicate-free message run to a leaf's pairs.
+     */
+    static void applyToLeaf(Node* leaf, Message* msg, Message* msgEnd) {
+        vector<K> keys;
+        vector<V> values;
+        keys.reserve(leaf->keys.size() + (msgEnd - msg));
+        values.reserve(leaf->keys.size() + (msgEnd - msg));
+
+        size_t i = 0;
+        while (i < leaf->keys.size() || msg != msgEnd) {
+            if (msg == msgEnd || (i < leaf->keys.size() && leaf->keys[i] < msg->key)) {
+                keys.push_back(std::move(leaf->keys[i]));
+                values.push_back(std::move(leaf->values[i]));
+                i++;
+                continue;
+            }
+            if (i < leaf->keys.size() && !(msg->key < leaf->keys[i])) {
+                i++;   // The message overrides the stored pair
+            }
+            if (!msg->isDelete) {
+                keys.push_back(std::move(msg->key));
+                values.push_back(std::move(msg->value));
+            }
+            ++msg;
+        }
+        leaf->keys = std::move(keys);
+        leaf->values = std::move(values);
+    }
+
+    /**
+     * @brief Splits children[i] of 'parent' in half; the right half becomes children[i + 1].
+     *
+     * For a leaf, a copy of the right half's first key becomes the pivot. For an internal
+     * node, the middle pivot moves up and the buffer is divided at it.
+     */
+    void splitChild(Node* parent, size_t i) {
+        Node* left = parent->children[i];
+        Node* right = new Node(left->isLeaf);
+        K pivot;
+
+        if (left->isLeaf) {
+            size_t half = left->keys.size() / 2;
+            right->keys.assign(make_move_iterator(left->keys.begin() + half), make_move_iterator(left->keys.end()));
+            right->values.assign(make_move_iterator(left->values.begin() + half),
+                                 make_move_iterator(left->values.end()));
+            left->keys.resize(half);
+            left->values.resize(half);
+            pivot = right->keys[0];
+        } else {
+            size_t half = left->children.size() / 2;
+            pivot = std::move(left->keys[half - 1]);
+            right->keys.assign(make_move_iterator(left->keys.begin() + half), make_move_iterator(left->keys.end()));
+            right->children.assign(left->children.begin() + half, left->children.end());
+            left->keys.resize(half - 1);
+            left->children.resize(half);
+
+            auto cut = lower_bound(left->buffer.begin(), left->buffer.end(), Message{pivot, V(), false}, keyLess);
+            right->buffer.assign(make_move_iterator(cut), make_move_iterator(left->buffer.end()));
+            left->buffer.erase(cut, left->buffer.end());
+        }
+
+        parent->keys.insert(parent->keys.begin() + i, std::move(pivot));
+        parent->children.insert(parent->children.begin() + i + 1, right);
+    }
+
+    /**
+     * @brief Splits children[i] of 'parent', and every piece split off it, until all of them fit.
+     *
+     * One flush can grow a child by a whole buffer, so a single halving is not always enough.
+     */
+    void splitOverfull(Node* parent, size_t i) {
+        size_t last = i;
+        while (i <= last) {
+            if (overfull(parent->children[i])) {
+                splitChild(parent, i);
+                last++;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    /**
+     * @brief Empties the buffer of 'node' into its children.
+     *
+     * The buffer is sorted, so the messages for each child form one contiguous run. Children
+     * are visited right to left so splitting one does not shift the runs still to be handed out.
+     */
+    void flush(Node* node) {
+        vector<Message> buffer = std::move(node->buffer);
+        node->buffer.clear();
+
+        // bounds[c] .. bounds[c + 1] is the run for children[c]
+        vector<size_t> bounds(node->children.size() + 1);
+        bounds[0] = 0;
+        for (size_t c = 0; c + 1 < node->children.size(); c++) {
+            auto cut = lower_bound(buffer.begin() + bounds[c], buffer.end(), Message{node->keys[c], V(), false}, keyLess);
+            bounds[c + 1] = cut - buffer.begin();
+        }
+        bounds[node->children.size()] = buffer.size();
+
+        for (size_t c = node->children.size(); c-- > 0;) {
+            if (bounds[c] == bounds[c + 1]) {
+                continue;
+            }
+            Node* child = node->children[c];
+            Message* run = buffer.data() + bounds[c];
+            Message* runEnd = buffer.data() + bounds[c + 1];
+
+            if (child->isLeaf) {
+                applyToLeaf(child, run, runEnd);
+            } else {
+                child->buffer = mergeMessages(child->buffer, run, runEnd);
+                if (child->buffer.size() > bufferCapacity) {
+                    flush(child);
+                }
+            }
+            splitOverfull(node, c);
+        }
+    }
+
+    /**
+     * @brief Sorts the pending log into the root's buffer (or straight into a leaf root).
+     */
+    void drainPending() {
+        if (pending.empty()) {
+            return;
+        }
+        // Stable, so among messages for the same key the last one sent stays last and wins
+        stable_sort(pending.begin(), pending.end(), keyLess);
+        size_t unique = 0;
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (i + 1 < pending.size() && !(pending[i].key < pending[i + 1].key)) {
+                continue;
+            }
+            if (unique != i) {
+                pending[unique] = std::move(pending[i]);
+            }
+            unique++;
+        }
+        pending.resize(unique);
+
+        if (root->isLeaf) {
+            applyToLeaf(root, pending.data(), pending.data() + pending.size());
+        } else {
+            root->buffer = mergeMessages(root->buffer, pending.data(), pending.data() + pending.size());
+            if (root->buffer.size() > bufferCapacity) {
+                flush(root);
+            }
+        }
+        pending.clear();
+
+        // The tree grows at the top: an overfull root goes under a new root and is split there
+        while (overfull(root)) {
+            Node* newRoot = new Node(false);
+            newRoot->children.push_back(root);
+            root = newRoot;
+            splitOverfull(root, 0);
+        }
+    }
+
+    /**
+     * @brief Pushes every buffered message in the subtree down to the leaves.
+     */
+    void flushSubtree(Node* node) {
+        if (node->isLeaf) {
+            return;
+        }
+        if (!node->buffer.empty()) {
+            flush(node);
+        }
+        for (Node* child : node->children) {
+            flushSubtree(child);
+        }
+    }
+
+    void clearSubtree(Node* node) {
+        for (Node* child : node->children) {
+            clearSubtree(child);
+        }
+        delete node;
+    }
+
+    void printSubtree(const Node* node) const {
+        if (node->isLeaf) {
+            for (const K& key : node->keys) {
+                cout << key << " ";
+            }
+            return;
+        }
+        for (const Node* child : node->children) {
+            printSubtree(child);
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor for BETree.
+     *
+     * @param leafCapacity Most pairs a leaf holds before it is split.
+     * @param maxFanout Most children an internal node has before it is split.
+     * @param bufferCapacity Messages an internal node buffers before flushing them to its children.
+     */
+    BETree(size_t leafCapacity = 256, size_t maxFanout = 16, size_t bufferCapacity = 1024)
+            : root(new Node(true)), leafCapacity(leafCapacity), maxFanout(maxFanout), bufferCapacity(bufferCapacity) {
+        pending.reserve(PendingCapacity);
+    }
+
+    BETree(const BETree&) = delete;
+    BETree& operator=(const BETree&) = delete;
+
+    ~BETree() {
+        clearSubtree(root);
+    }
+
+    /**
+     * @brief Insert a key-value pair, or replace the value if the key is already there.
+     *
+     * Only appends a message; the tree itself changes when the pending log is drained.
+     */
+    void insert(const K& key, const V& value) {
+        pending.push_back(Message{key, value, false});
+        if (pending.size() == PendingCapacity) {
+            drainPending();
+        }
+    }
+
+    /**
+     * @brief Delete a key, if it is there.
+     */
+    void remove(const K& key) {
+        pending.push_back(Message{key, V(), true});
+        if (pending.size() == PendingCapacity) {
+            drainPending();
+        }
+    }
+
+    /**
+     * @brief Look up the current value of a key, checking the buffers on the way down.
+     *
+     * @return const V* Pointer to the value, or nullptr if the key is not in the tree. Valid
+     *         until the next insert() or remove().
+     */
+    const V* find(const K& key) const {
+        // The newest message for the key is the last one in the pending log
+        for (size_t i = pending.size(); i-- > 0;) {
+            if (!(pending[i].key < key) && !(key < pending[i].key)) {
+                return pending[i].isDelete ? nullptr : &pending[i].value;
+            }
+        }
+
+        const Node* node = root;
+        while (!node->isLeaf) {
+            auto it = lower_bound(node->buffer.begin(), node->buffer.end(), Message{key, V(), false}, keyLess);
+            if (it != node->buffer.end() && !(key < it->key)) {
+                return it->isDelete ? nullptr : &it->value;
+            }
+            node = node->children[childIndex(node, key)];
+        }
+
+        int pos = KeyRank<K>::lower(node->keys.data(), int(node->keys.size()), key);
+        if (pos < int(node->keys.size()) && !(key < node->keys[pos])) {
+            return &node->values[pos];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Search for a key in the tree.
+     */
+    bool search(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Push every buffered message down to the leaves, e.g. before a long read-only phase.
+     */
+    void flushAll() {
+        drainPending();
+        flushSubtree(root);
+    }
+
+    /**
+     * @brief Number of levels in the tree, counting the leaves.
+     */
+    int height() const {
+        int levels = 1;
+        for (const Node* node = root; !node->isLeaf; node = node->children[0]) {
+            levels++;
+        }
+        return levels;
+    }
+
+    /**
+     * @brief Apply every buffered message, then print the keys in sorted order.
+     */
+    void printInOrder() {
+        flushAll();
+        printSubtree(root);
+        cout << endl;
+    }
+};
+
+// --- Benchmark ---
+
+/**
+ * @brief splitmix64 finalizer, a bijection on 64-bit integers (distinct keys in random order).
+ */
+static uint64_t mixKey(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static double nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Random-key ingest throughput, BTree vs BETree, and what the buffers cost lookups.
+ */
+void benchmarkIngest(size_t numKeys) {
+    cout << numKeys << " random inserts" << endl;
+
+    const size_t numLookups = 1'000'000;
+    mt19937_64 rng(5);
+    vector<uint64_t> probes(numLookups);
+    for (uint64_t& probe : probes) {
+        probe = mixKey(rng() % numKeys);
+    }
+    uint64_t btreeSum = 0;
+
+    {
+        BTree<uint64_t, uint64_t> tree(32);
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < numKeys; i++) {
+            tree.insert(mixKey(i), i);
+        }
+        double seconds = nanosSince(start) / 1e9;
+
+        start = chrono::steady_clock::now();
+        for (uint64_t probe : probes) {
+            btreeSum += *tree.find(probe);
+        }
+        double lookup = nanosSince(start) / numLookups;
+        cout << "  BTree t = 32:  " << numKeys / seconds / 1e6 << " M inserts/s, lookup " << lookup << " ns" << endl;
+    }
+
+    {
+        BETree<uint64_t, uint64_t> tree;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < numKeys; i++) {
+            tree.insert(mixKey(i), i);
+        }
+        double seconds = nanosSince(start) / 1e9;
+
+        uint64_t sum = 0;
+        start = chrono::steady_clock::now();
+        for (uint64_t probe : probes) {
+            sum += *tree.find(probe);
+        }
+        bool same = sum == btreeSum;
+        double buffered = nanosSince(start) / numLookups;
+
+        start = chrono::steady_clock::now();
+        tree.flushAll();
+        double flushMillis = nanosSince(start) / 1e6;
+
+        start = chrono::steady_clock::now();
+        for (uint64_t probe : probes) {
+            sum -= *tree.find(probe);
+        }
+        same = same && sum == 0;
+        double flushed = nanosSince(start) / numLookups;
+        cout << "  BETree:        " << numKeys / seconds / 1e6 << " M inserts/s, lookup " << buffered
+             << " ns (" << flushed << " ns after a " << flushMillis << " ms flushAll, height " << tree.height()
+             << ")" << (same ? "" : " (mismatch)") << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BETree<int, string> tree(4, 4, 8);
+    for (int key = 1; key <= 40; key++) {
+        tree.insert(key * 7 % 41, "v" + to_string(key));
+    }
+    tree.remove(14);
+    tree.remove(21);
+    tree.insert(5, "five");
+    cout << "14 found: " << tree.search(14) << ", 5 -> " << *tree.find(5) << endl;
+    tree.printInOrder();
+
+    // Pass "full" for the 100M-key ingest run
+    bool full = argc > 1 && string(argv[1]) == "full";
+    benchmarkIngest(full ? 100'000'000 : 2'000'000);
+
+    return 0;
+}
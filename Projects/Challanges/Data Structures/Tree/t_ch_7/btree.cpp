@@ -1,6 +1,10 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "btree.h"
 
 /*
  * Btree of order m is in short a tree where every node can have at most m children and can store at most m-1 keys
@@ -205,37 +209,21 @@
 
 using namespace std;
 
-//The factor of 2 comes from the maximum size of a node being roughly twice the minimum size (i.e., each node can hold between t−1t−1 and 2t−12t−1 keys).
-//Therefore, the vector for keys and values must reserve space for up to 2t−12t−1 slots, and the vector for children must reserve up to 2t2t slots.
+// --- Benchmarks ---
 
 /**
- * @brief BTree class
- *
- * A B-Tree of minimum degree `t`. Each node can have up to `2t - 1` keys.
- * This skeleton outlines the structure and the primary methods you’d typically implement.
+ * @brief The node layout btree.h used before the flat nodes: three separately allocated vectors per node.
+ * Only insert and search are kept, so the lookup benchmark has a baseline to compare against.
  */
 template <typename K, typename V>
-class BTree {
+class VectorNodeBTree {
 private:
-    /**
-     * @brief BTreeNode struct
-     *
-     * Each node stores:
-     * - A vector of keys
-     * - A vector of associated values (or you can store pairs if you prefer)
-     * - A vector of child pointers (each child is another BTreeNode)
-     * - A boolean flag to indicate if the node is a leaf
-     * - A count of the current number of keys
-     *
-     * Note: In a typical B-Tree, the number of children is always (number_of_keys + 1),
-     *       except for leaf nodes which have 0 children.
-     */
     struct BTreeNode {
-        bool isLeaf;                  // True if node is leaf
-        vector<K> keys;         // Node's keys
-        vector<V> values;       // Values associated with each key
-        vector<BTreeNode*> children; // Child pointers
-        int numKeys;                 // Current number of keys stored in this node
+        bool isLeaf;
+        vector<K> keys;
+        vector<V> values;
+        vector<BTreeNode*> children;
+        int numKeys;
 
         BTreeNode(bool leaf, int t) : isLeaf(leaf), numKeys(0) {
             keys.resize(2 * t - 1);
@@ -244,310 +232,609 @@ private:
         }
     };
 
-    BTreeNode* root; // Pointer to the root of the B-Tree
-    int t;           // Minimum degree (each node can have [t-1 .. 2t-1] keys, except possibly root)
-
-    // --- Utility (Private) Methods ---
+    BTreeNode* root;
+    int t;
 
-    /**
-     * @brief Splits the child of 'parentNode' at index 'childIndex' when it is full.
-     * This is a fundamental operation in B-Trees during insertion.
-     *
-     * @param parentNode The node that has a full child.
-     * @param childIndex The index of the child to split.
-     */
     void splitChild(BTreeNode* parentNode, int childIndex) {
-        // 1) Grab the child that’s full
         BTreeNode* fullChild = parentNode->children[childIndex];
-
-        // 2) Create a new node to hold the upper (t - 1) keys of fullChild
         BTreeNode* newNode = new BTreeNode(fullChild->isLeaf, t);
-
-        // 'mid' is the index of the key that will move up to the parent.
-        // Typically, we promote the (t-1)-th key (0-based index).
         int mid = t - 1;
 
-        // 3) Copy the top (t - 1) keys and values from fullChild into newNode
-        //    These are the keys after the median.
         for (int i = 0; i < mid; i++) {
             newNode->keys[i]   = fullChild->keys[i + t];
             newNode->values[i] = fullChild->values[i + t];
         }
-
-        // If the child is not a leaf, copy its top 't' children as well
         if (!fullChild->isLeaf) {
             for (int i = 0; i < t; i++) {
                 newNode->children[i] = fullChild->children[i + t];
             }
         }
-
-        // 4) Update the numKeys in the new node
         newNode->numKeys = mid;
-
-        // 5) Reduce the key count in the fullChild (it loses the top half)
         fullChild->numKeys = mid;
-        // After the split, 'fullChild' keeps [0..(mid-1)] of its keys.
-        // The median key at index 'mid' will move up to the parent.
 
-        // -----------------------------------------------------------------
-        // Move parent’s children to make space for the new child
-        // (We shift everything right by 1 from the back)
-        // -----------------------------------------------------------------
         for (int i = parentNode->numKeys; i > childIndex; i--) {
             parentNode->children[i + 1] = parentNode->children[i];
         }
         parentNode->children[childIndex + 1] = newNode;
-
-        // -----------------------------------------------------------------
-        // Move parent’s keys/values to make space for the median key
-        // (Shift them right by 1 from the back)
-        // -----------------------------------------------------------------
         for (int i = parentNode->numKeys - 1; i > childIndex - 1; i--) {
             parentNode->keys[i + 1]   = parentNode->keys[i];
             parentNode->values[i + 1] = parentNode->values[i];
         }
-
-        // 6) The median key of fullChild moves up to parent
         parentNode->keys[childIndex]   = fullChild->keys[mid];
         parentNode->values[childIndex] = fullChild->values[mid];
-
-        // 7) The parent now has one more key
         parentNode->numKeys++;
     }
 
-    /**
-     * @brief Inserts a key-value pair into a non-full node of the B-Tree.
-     *
-     * @param node The current node where the key is being inserted. This changes as we descend the tree.
-     * @param key The key to insert.
-     * @param value The value to insert.
-    */
     void insertNonFull(BTreeNode* node, const K& key, const V& value) {
-        // TODO: Implement insertion logic:
-        // 1) If node is a leaf, insert key/value in sorted position among existing keys.
-        // 2) If node is not a leaf, find the correct child to descend into; if that child is full, split it first, then descend again.
         if (node->isLeaf) {
             int i = node->numKeys - 1;
-
-            // Shift to the right until we find the position
             while (i >= 0 && node->keys[i] > key) {
                 node->keys[i + 1]   = node->keys[i];
                 node->values[i + 1] = node->values[i];
                 i--;
             }
-
-            // Now 'i' is either -1 or points to a key <= 'key'
             node->keys[i + 1]   = key;
             node->values[i + 1] = value;
             node->numKeys++;
         } else {
-            // Start from the rightmost key in the node.
             int i = node->numKeys - 1;
-
-            //
-
-            // Move i leftward while the new key is smaller than node->keys[i].
-            // That means we haven't found the correct "range" yet.
             while (i >= 0 && key < node->keys[i]) {
                 i--;
             }
-
-            // Now we've found where K fits among the node's keys.
-            // The child pointer we descend into is at index (i + 1).
             int childIndex = i + 1;
-
-            // If that child is full, we split it first.
             if (node->children[childIndex]->numKeys == (2*t - 1)) {
                 splitChild(node, childIndex);
-
-                // After splitting, one key moves up to the parent,
-                // and the original child is cut in half. We decide
-                // whether to go left or right.
                 if (key > node->keys[childIndex]) {
                     childIndex++;
                 }
             }
-
-            // Finally, we insert into that child (recursively).
             insertNonFull(node->children[childIndex], key, value);
         }
     }
 
-    /**
-     * @brief Searches for a key in the subtree rooted at 'node'.
-     *
-     * @param node The root of the subtree in which to search.
-     * @param key The key to search for.
-     * @return bool True if key is found, false otherwise.
-     */
-    bool searchNode(BTreeNode* node, const K& key) {
-        // TODO: Use the B-Tree search logic:
-        // 1) Find the first key in 'node->keys' that is >= key.
-        // 2) If that key == key, return true.
-        // 3) If node is leaf, return false because key not found.
-        // 4) Else, recursively search in the appropriate child.
-        return false;
+    void clearSubtree(BTreeNode* node) {
+        if (node == nullptr) {
+            return;
+        }
+        if (!node->isLeaf) {
+            for (int i = 0; i <= node->numKeys; i++) {
+                clearSubtree(node->children[i]);
+            }
+        }
+        delete node;
     }
 
-    /**
-     * @brief Removes a key from the subtree rooted at 'node'.
-     *
-     * @param node The subtree root in which to remove the key.
-     * @param key The key to remove.
-     */
-    void removeNode(BTreeNode* node, const K& key) {
-        // TODO: B-Tree removal can be done in multiple steps:
-        // 1) If key is in node and node is a leaf, remove the key from node.
-        // 2) If key is in node and node is internal, you can either:
-        //    a) Replace the key with its predecessor/successor and recursively remove from child, OR
-        //    b) Merge children if needed.
-        // 3) If key is not in node, search the correct child and ensure that child has at least t keys (split/merge if needed).
-    }
-
-    /**
-     * @brief Print in-order traversal of the keys in the subtree rooted at 'node'.
-     *
-     * @param node The subtree root.
-     */
-    void printInOrderNode(BTreeNode* node) {
-        // For each key i in [0..numKeys-1]:
-        //   1) Recursively print the subtree in children[i]
-        //   2) Print key[i]
-        //   3) (In a B-Tree, children.size() = numKeys + 1 for internal nodes)
-        // Print the subtree in children[numKeys] at the end.
-    }
-
-    /**
-     * @brief Deallocates memory for the subtree rooted at 'node'.
-     *
-     * @param node The subtree root to clear.
-     */
-    void clearSubtree(BTreeNode* node) {
+public:
+    VectorNodeBTree(int t) : root(nullptr), t(t) {}
 
+    ~VectorNodeBTree() {
+        clearSubtree(root);
     }
 
-public:
-    /**
-     * @brief Constructor for BTree.
-     *
-     * @param t The minimum degree of the B-Tree. Must be >= 2 for a valid B-Tree.
-     */
-    BTree(int t) : root(nullptr), t(t) {
-        // Usually, we initialize an empty tree with a single root node that is a leaf.
-        // But you can also keep it as nullptr until the first insertion.
-    }
-
-    /**
-     * @brief Destructor for BTree. Deallocates all nodes.
-     */
-    ~BTree() {
-        clear();
-    }
-
-    /**
-    * @brief Insert a key-value pair into the B-Tree.
-    *
-    * Steps:
-        *  1) If the root is null, create a new leaf root (store key/value).
-        *  2) If the root is full, split it first.
-            *     - Create a new node as the parent of the old root.
-            *     - Call splitChild(newRoot, 0).
-            *     - Decide if we go left or right child for the insertion.
-     *  3) Otherwise, just call insertNonFull on the existing root.
-    */
     void insert(const K& key, const V& value) {
-        // 1) If the tree is empty (root == nullptr):
         if (root == nullptr) {
-            // Create a new root node as a leaf
-            root = new BTreeNode(true, t); // (isLeaf=true, t=degree)
+            root = new BTreeNode(true, t);
             root->keys[0] = key;
             root->values[0] = value;
             root->numKeys = 1;
-            return; // Done
+            return;
         }
-
-        // 2) If the root is full (has 2t - 1 keys), split it before descending
         if (root->numKeys == (2 * t - 1)) {
-            // Create a new node to become the new root (this new root is not a leaf)
             BTreeNode* newRoot = new BTreeNode(false, t);
-
-            // The old root becomes newRoot->children[0]
             newRoot->children[0] = root;
-
-            // Split the old root (child at index 0 of newRoot)
             splitChild(newRoot, 0);
+            root = newRoot;
+        }
+        insertNonFull(root, key, value);
+    }
 
-            // Now decide which child to descend into based on the key
-            int childIndex = 0;
-            if (key > newRoot->keys[0]) {
-                childIndex = 1;
+    bool search(const K& key) {
+        BTreeNode* node = root;
+        while (node != nullptr) {
+            int i = 0;
+            while (i < node->numKeys && node->keys[i] < key) {
+                i++;
+            }
+            if (i < node->numKeys && !(key < node->keys[i])) {
+                return true;
+            }
+            if (node->isLeaf) {
+                return false;
             }
+            node = node->children[i];
+        }
+        return false;
+    }
+};
 
-            // Insert the key into the appropriate child
-            insertNonFull(newRoot->children[childIndex], key, value);
+/**
+ * @brief splitmix64 finalizer. It is a bijection on 64-bit integers, so mixKey(0..n-1)
+ * gives n distinct keys in random order without storing them.
+ */
+static uint64_t mixKey(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
 
-            // newRoot is our actual root now
-            root = newRoot;
+static double nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Fills 'tree' with 'numKeys' random keys and returns the average latency of one
+ * successful point lookup, in nanoseconds.
+ */
+template <typename Tree>
+double pointLookupNanos(Tree& tree, size_t numKeys, size_t numLookups) {
+    for (size_t i = 0; i < numKeys; i++) {
+        tree.insert(mixKey(i), i);
+    }
+
+    mt19937_64 rng(42);
+    size_t found = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numLookups; i++) {
+        found += tree.search(mixKey(rng() % numKeys));
+    }
+    double nanos = nanosSince(start) / numLookups;
+
+    if (found != numLookups) {
+        cout << "  lookup benchmark lost keys: " << found << "/" << numLookups << endl;
+    }
+    return nanos;
+}
+
+/**
+ * @brief Times the in-node rank on one full node (2t - 1 sorted keys): the old linear scan
+ * against the KeyRank kernel that btree.h now uses.
+ */
+template <typename K>
+void benchmarkNodeRank(int degree) {
+    const int numKeys = 2 * degree - 1;
+    const size_t rounds = 2'000'000;
+
+    vector<K> keys(numKeys);
+    for (int i = 0; i < numKeys; i++) {
+        keys[i] = static_cast<K>(i * 2);
+    }
+
+    mt19937_64 rng(7);
+    vector<K> needles(1024);
+    for (K& needle : needles) {
+        needle = static_cast<K>(rng() % (2 * numKeys));
+    }
+
+    size_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        const K& key = needles[r & 1023];
+        int i = 0;
+        while (i < numKeys && keys[i] < key) {
+            i++;
         }
-        else {
-            // 3) If root is not full, just insert into it
-            insertNonFull(root, key, value);
+        sink += i;
+    }
+    double linear = nanosSince(start) / rounds;
+
+    start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        sink += KeyRank<K>::lower(keys.data(), numKeys, needles[r & 1023]);
+    }
+    double ranked = nanosSince(start) / rounds;
+
+    cout << "  t = " << degree << ": linear " << linear << " ns, KeyRank " << ranked << " ns"
+         << (KeyRank<K>::Vectorized ? " (SIMD)" : " (binary search)") << (sink == 0 ? " " : "") << endl;
+}
+
+/**
+ * @brief Compares point-lookup latency of the flat node layout against the old vector-based node.
+ *
+ * The result depends on the build: without SSE4.2 there is no SIMD kernel for 64-bit keys, and
+ * the flat tree ranks each node with a binary search over prefetched key lines instead.
+ *
+ * @param numKeys Number of keys in each tree (1M stays mostly in cache, 100M is DRAM bound).
+ * @param degree Minimum degree 't' used by both trees.
+ */
+void benchmarkPointLookups(size_t numKeys, int degree) {
+    const size_t numLookups = 1'000'000;
+    cout << "Point lookups, " << numKeys << " keys, t = " << degree << endl;
+
+    {
+        VectorNodeBTree<uint64_t, uint64_t> tree(degree);
+        cout << "  vector nodes: " << pointLookupNanos(tree, numKeys, numLookups) << " ns/lookup" << endl;
+    }
+    {
+        BTree<uint64_t, uint64_t> tree(degree);
+        cout << "  flat nodes:   " << pointLookupNanos(tree, numKeys, numLookups) << " ns/lookup" << endl;
+    }
+}
+
+/**
+ * @brief Loads the same pre-sorted rows with repeated insert() and with bulkLoad(), and
+ * reports build time and resulting tree height.
+ */
+void benchmarkBulkLoad(size_t numKeys, int degree) {
+    cout << "Loading " << numKeys << " sorted keys, t = " << degree << endl;
+
+    vector<pair<uint64_t, uint64_t>> rows(numKeys);
+    for (size_t i = 0; i < numKeys; i++) {
+        rows[i] = {i * 2, i};
+    }
+
+    {
+        BTree<uint64_t, uint64_t> tree(degree);
+        auto start = chrono::steady_clock::now();
+        for (const auto& row : rows) {
+            tree.insert(row.first, row.second);
         }
+        cout << "  insert():         " << nanosSince(start) / 1e6 << " ms, height " << tree.height() << endl;
+    }
+    for (double fillFactor : {1.0, 0.7}) {
+        BTree<uint64_t, uint64_t> tree(degree);
+        auto start = chrono::steady_clock::now();
+        tree.bulkLoad(rows.begin(), rows.end(), fillFactor);
+        cout << "  bulkLoad, fill " << fillFactor << ": " << nanosSince(start) / 1e6
+             << " ms, height " << tree.height() << endl;
     }
+}
 
+/**
+ * @brief Inserts random keys and then clears the tree, once per node allocator.
+ */
+template <typename Alloc>
+void timeInsertAndClear(const char* name, size_t numKeys, int degree) {
+    BTree<uint64_t, uint64_t, 0, Alloc> tree(degree);
 
-    /**
-     * @brief Search for a key in the B-Tree.
-     *
-     * @param key The key to search for.
-     * @return bool True if key is found, false otherwise.
-     */
-    bool search(const K& key) {
-        return searchNode(root, key);
-    }
-
-    /**
-     * @brief Remove a key from the B-Tree.
-     *
-     * Typical steps:
-     * 1) If key exists in root, remove it from the root using removeNode().
-     * 2) If after removal, the root has 0 keys (and is not a leaf), make its first child the new root.
-     *
-     * @param key The key to remove.
-     */
-    void remove(const K& key) {
-        // TODO: Implement the public remove logic.
-        // 1) If root is null, do nothing.
-        // 2) Otherwise, call removeNode on root.
-        // 3) If root->numKeys == 0 and root is not leaf, make the first child the new root.
-    }
-
-    /**
-     * @brief Print the B-Tree keys in sorted (in-order) order.
-     */
-    void printInOrder() {
-        printInOrderNode(root);
-        cout << endl;
-    }
-
-    /**
-     * @brief Remove all nodes from the B-Tree, making it empty.
-     */
-    void clear() {
-        clearSubtree(root);
-        root = nullptr;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        tree.insert(mixKey(i), i);
+    }
+    double insertNanos = nanosSince(start) / numKeys;
+
+    start = chrono::steady_clock::now();
+    tree.clear();
+    double clearMillis = nanosSince(start) / 1e6;
+
+    cout << "  " << name << insertNanos << " ns/insert, clear() " << clearMillis << " ms" << endl;
+}
+
+/**
+ * @brief Compares the default arena allocator with one heap allocation per node.
+ */
+void benchmarkNodeAllocators(size_t numKeys, int degree) {
+    cout << "Node allocators, " << numKeys << " random keys, t = " << degree << endl;
+    timeInsertAndClear<HeapNodeAllocator>("heap:  ", numKeys, degree);
+    timeInsertAndClear<ArenaNodeAllocator>("arena: ", numKeys, degree);
+}
+
+/**
+ * @brief Scans every key of a bulk-loaded tree with a cursor, then reads random pages of 100
+ * keys with lower_bound() + 100 steps, and reports the cost per key.
+ */
+void benchmarkRangeScan(size_t numKeys, int degree) {
+    cout << "Range scans, " << numKeys << " sequential keys, t = " << degree << endl;
+
+    vector<pair<uint64_t, uint64_t>> rows(numKeys);
+    for (size_t i = 0; i < numKeys; i++) {
+        rows[i] = {i, i};
+    }
+    BTree<uint64_t, uint64_t> tree(degree);
+    tree.bulkLoad(rows.begin(), rows.end(), 1.0);
+    rows.clear();
+    rows.shrink_to_fit();
+
+    uint64_t sum = 0;
+    auto start = chrono::steady_clock::now();
+    for (auto cursor = tree.lower_bound(0); cursor.valid(); ++cursor) {
+        sum += cursor.value();
+    }
+    cout << "  full scan: " << nanosSince(start) / numKeys << " ns/key" << endl;
+
+    const size_t pages = 100'000;
+    const int pageSize = 100;
+    mt19937_64 rng(3);
+    start = chrono::steady_clock::now();
+    for (size_t p = 0; p < pages; p++) {
+        auto cursor = tree.lower_bound(rng() % numKeys);
+        for (int i = 0; i < pageSize && cursor.valid(); i++, ++cursor) {
+            sum += cursor.value();
+        }
+    }
+    cout << "  pages of " << pageSize << ": " << nanosSince(start) / (pages * pageSize) << " ns/key"
+         << (sum == 0 ? " " : "") << endl;
+}
+
+/**
+ * @brief One insert()/find() per key vs insertBatch()/findBatch(), on a tree of 'numKeys' random keys.
+ */
+void benchmarkBatchOps(size_t numKeys, int degree, size_t batchSize) {
+    cout << "Batches of " << batchSize << ", tree of " << numKeys << " random keys, t = " << degree << endl;
+
+    BTree<uint64_t, uint64_t> single(degree);
+    BTree<uint64_t, uint64_t> batched(degree);
+    for (size_t i = 0; i < numKeys; i++) {
+        single.insert(mixKey(i), i);
+        batched.insert(mixKey(i), i);
+    }
+
+    // Ingest another numKeys / 4 new keys
+    size_t numNew = numKeys / 4;
+    vector<pair<uint64_t, uint64_t>> batch(batchSize);
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = numKeys; i < numKeys + numNew; i++) {
+        single.insert(mixKey(i), i);
+    }
+    double singleInsert = nanosSince(start) / numNew;
+
+    start = chrono::steady_clock::now();
+    for (size_t first = numKeys; first < numKeys + numNew; first += batchSize) {
+        size_t count = min(batchSize, numKeys + numNew - first);
+        for (size_t j = 0; j < count; j++) {
+            batch[j] = {mixKey(first + j), first + j};
+        }
+        batched.insertBatch(span(batch.data(), count));
+    }
+    double batchInsert = nanosSince(start) / numNew;
+    cout << "  insert: " << singleInsert << " ns/key one by one, " << batchInsert << " ns/key batched" << endl;
+
+    // Look up random keys that are all present
+    const size_t numLookups = 1'000'000;
+    mt19937_64 rng(11);
+    vector<uint64_t> keys(numLookups);
+    for (uint64_t& key : keys) {
+        key = mixKey(rng() % (numKeys + numNew));
+    }
+    vector<uint64_t*> results(numLookups);
+
+    uint64_t sum = 0;
+    start = chrono::steady_clock::now();
+    for (uint64_t key : keys) {
+        sum += *single.find(key);
+    }
+    double singleFind = nanosSince(start) / numLookups;
+
+    start = chrono::steady_clock::now();
+    for (size_t first = 0; first < numLookups; first += batchSize) {
+        size_t count = min(batchSize, numLookups - first);
+        batched.findBatch(span<const uint64_t>(keys.data() + first, count), span(results.data() + first, count));
+    }
+    double batchFind = nanosSince(start) / numLookups;
+    for (uint64_t* value : results) {
+        sum -= *value;
+    }
+    cout << "  find:   " << singleFind << " ns/key one by one, " << batchFind << " ns/key batched"
+         << (sum == 0 ? "" : " (mismatch)") << endl;
+}
+
+/**
+ * @brief Arena allocator that counts node allocations (splits) and frees (merges).
+ */
+class CountingNodeAllocator : public ArenaNodeAllocator {
+public:
+    static inline size_t allocations = 0;
+    static inline size_t deallocations = 0;
+
+    using ArenaNodeAllocator::ArenaNodeAllocator;
+
+    void* allocate() {
+        allocations++;
+        return ArenaNodeAllocator::allocate();
+    }
+
+    void deallocate(void* block) {
+        deallocations++;
+        ArenaNodeAllocator::deallocate(block);
     }
 };
 
+/**
+ * @brief Runs the same delete-heavy workload (55% remove, 45% insert) with different delete thresholds.
+ *
+ * Reports the time per operation and how many nodes were split off and merged away during the
+ * run, then the cost of one compact() at the end.
+ */
+void benchmarkLazyDelete(size_t numKeys, int degree) {
+    cout << "Delete-heavy churn, " << numKeys << " random keys then " << numKeys
+         << " ops (55% remove / 45% insert), t = " << degree << endl;
+
+    // One fixed operation stream: the keys alive at each step do not depend on the tree
+    vector<uint64_t> live(numKeys);
+    for (size_t i = 0; i < numKeys; i++) {
+        live[i] = mixKey(i);
+    }
+    struct Op {
+        bool remove;
+        uint64_t key;
+    };
+    vector<Op> ops(numKeys);
+    mt19937_64 rng(21);
+    uint64_t nextKey = numKeys;
+    for (Op& op : ops) {
+        if (rng() % 100 < 55 && !live.empty()) {
+            size_t index = rng() % live.size();
+            op = {true, live[index]};
+            live[index] = live.back();
+            live.pop_back();
+        } else {
+            op = {false, mixKey(nextKey++)};
+            live.push_back(op.key);
+        }
+    }
+
+    for (int threshold : {degree - 1, degree / 4, 1}) {
+        BTree<uint64_t, uint64_t, 0, CountingNodeAllocator> tree(degree);
+        tree.setDeleteThreshold(threshold);
+        for (size_t i = 0; i < numKeys; i++) {
+            tree.insert(mixKey(i), i);
+        }
+
+        CountingNodeAllocator::allocations = 0;
+        CountingNodeAllocator::deallocations = 0;
+        auto start = chrono::steady_clock::now();
+        for (const Op& op : ops) {
+            if (op.remove) {
+                tree.remove(op.key);
+            } else {
+                tree.insert(op.key, op.key);
+            }
+        }
+        double opNanos = nanosSince(start) / ops.size();
+        size_t splits = CountingNodeAllocator::allocations;
+        size_t merges = CountingNodeAllocator::deallocations;
+
+        start = chrono::steady_clock::now();
+        tree.compact();
+        double compactMillis = nanosSince(start) / 1e6;
+
+        cout << "  threshold " << threshold << (threshold == degree - 1 ? " (eager): " : ":  ") << opNanos
+             << " ns/op, " << splits << " nodes split off, " << merges << " merged away; compact() "
+             << compactMillis << " ms, " << CountingNodeAllocator::deallocations - merges << " merged" << endl;
+    }
+}
+
+/**
+ * @brief Time to fill 'tree' with 'numKeys' random keys and clear it again, 'rounds' times, in ns per insert.
+ *
+ * The tree is kept small enough to stay in cache, so the time is the work done inside the nodes
+ * (rank, shifts, splits) rather than cache misses.
+ */
+template <typename Tree>
+double insertNanos(Tree& tree, size_t numKeys, int rounds) {
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < numKeys; i++) {
+            tree.insert(mixKey(i), i);
+        }
+        tree.clear();
+    }
+    return nanosSince(start) / (numKeys * rounds);
+}
+
+/**
+ * @brief Insert throughput with the degree as a constructor argument vs as a template argument.
+ */
+template <int Degree>
+void benchmarkCompileTimeDegree(size_t numKeys, int rounds) {
+    BTree<uint64_t, uint64_t> runtime(Degree);
+    BTree<uint64_t, uint64_t, Degree> compileTime;
+    RuntimeDegreeBTree<uint64_t, uint64_t> dispatched(Degree);
+
+    double runtimeNanos = insertNanos(runtime, numKeys, rounds);
+    double compileTimeNanos = insertNanos(compileTime, numKeys, rounds);
+    double dispatchedNanos = insertNanos(dispatched, numKeys, rounds);
+    cout << "  t = " << Degree << ": runtime " << runtimeNanos << " ns/insert, compile-time "
+         << compileTimeNanos << " ns/insert, dispatched " << dispatchedNanos << " ns/insert" << endl;
+}
+
+/**
+ * @brief Pagination by row offset on a Counted tree: select(offset) against stepping a cursor
+ * 'offset' times from begin(), plus the insert/remove overhead of keeping the counts.
+ *
+ * After the churn every rank() and select() answer is checked against a sorted copy of the keys.
+ */
+void benchmarkOrderStatistics(size_t numKeys, int degree) {
+    cout << "Order statistics, " << numKeys << " random keys, t = " << degree << endl;
+
+    BTree<uint64_t, uint64_t> plain(degree);
+    BTree<uint64_t, uint64_t, 0, ArenaNodeAllocator, true> counted(degree);
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        plain.insert(mixKey(i), i);
+    }
+    double plainInsert = nanosSince(start) / numKeys;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        counted.insert(mixKey(i), i);
+    }
+    double countedInsert = nanosSince(start) / numKeys;
+
+    // Remove every third key, so the borrow and merge paths get their share of the counts too
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i += 3) {
+        plain.remove(mixKey(i));
+    }
+    double plainRemove = nanosSince(start) / (numKeys / 3);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i += 3) {
+        counted.remove(mixKey(i));
+    }
+    double countedRemove = nanosSince(start) / (numKeys / 3);
+    cout << "  insert: " << plainInsert << " ns plain, " << countedInsert << " ns counted; remove: "
+         << plainRemove << " ns plain, " << countedRemove << " ns counted" << endl;
+
+    vector<uint64_t> sorted;
+    for (size_t i = 0; i < numKeys; i++) {
+        if (i % 3 != 0) {
+            sorted.push_back(mixKey(i));
+        }
+    }
+    sort(sorted.begin(), sorted.end());
+    size_t errors = counted.size() != sorted.size();
+    for (size_t k = 0; k < sorted.size(); k += 97) {
+        auto cursor = counted.select(k);
+        errors += !cursor.valid() || cursor.key() != sorted[k];
+        errors += counted.rank(sorted[k]) != k;
+        errors += counted.rank(sorted[k] + 1) != k + 1;
+    }
+    errors += counted.select(sorted.size()).valid();
+    cout << "  " << (errors == 0 ? "select/rank match the sorted keys" : "MISMATCHES: ") ;
+    if (errors != 0) {
+        cout << errors;
+    }
+    cout << endl;
+
+    const int pageSize = 100;
+    const size_t pages = 200;
+    mt19937_64 rng(16);
+    vector<size_t> offsets(pages);
+    for (size_t& offset : offsets) {
+        offset = rng() % sorted.size();
+    }
+
+    uint64_t sum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t offset : offsets) {
+        auto cursor = plain.begin();
+        for (size_t i = 0; i < offset; i++) {
+            ++cursor;
+        }
+        for (int i = 0; i < pageSize && cursor.valid(); i++, ++cursor) {
+            sum += cursor.value();
+        }
+    }
+    double skipMicros = nanosSince(start) / pages / 1e3;
+
+    start = chrono::steady_clock::now();
+    for (size_t offset : offsets) {
+        auto cursor = counted.select(offset);
+        for (int i = 0; i < pageSize && cursor.valid(); i++, ++cursor) {
+            sum -= cursor.value();
+        }
+    }
+    double selectMicros = nanosSince(start) / pages / 1e3;
+    cout << "  page of " << pageSize << " at a random offset: " << skipMicros << " us skipping, "
+         << selectMicros << " us with select()" << (sum == 0 ? "" : " ") << endl;
+
+    start = chrono::steady_clock::now();
+    size_t ranks = 0;
+    for (size_t i = 0; i < 1'000'000; i++) {
+        ranks += counted.rank(mixKey(rng() % numKeys));
+    }
+    cout << "  rank(): " << nanosSince(start) / 1'000'000 << " ns" << (ranks == 0 ? " " : "") << endl;
+}
+
 // --- Example usage (main) ---
-int main() {
+int main(int argc, char* argv[]) {
     BTree<int, string> btree(2); // Minimum degree t = 2
 
     btree.insert(10, "Ten");
     btree.insert(20, "Twenty");
     btree.insert(5,  "Five");
 
-    btree.printInOrder(); // Skeleton: no real output until methods are implemented
+    btree.printInOrder();
 
     if (btree.search(20)) {
         cout << "20 found in B-Tree" << endl;
@@ -559,5 +846,34 @@ int main() {
 
     btree.printInOrder();
 
+    // Pass "full" to also run the DRAM-sized benchmarks
+    bool full = argc > 1 && string(argv[1]) == "full";
+
+    cout << "In-node rank, uint32_t keys" << endl;
+    for (int degree : {32, 64, 128}) {
+        benchmarkNodeRank<uint32_t>(degree);
+    }
+
+    benchmarkPointLookups(1'000'000, 32);
+    benchmarkBulkLoad(1'000'000, 32);
+    benchmarkNodeAllocators(1'000'000, 8);
+    benchmarkRangeScan(10'000'000, 32);
+    benchmarkBatchOps(1'000'000, 32, 1'000);
+    benchmarkBatchOps(1'000'000, 32, 16'000);
+    benchmarkLazyDelete(1'000'000, 8);
+    cout << "Runtime vs compile-time degree, 50000 random inserts x 20" << endl;
+    benchmarkCompileTimeDegree<16>(50'000, 20);
+    benchmarkCompileTimeDegree<32>(50'000, 20);
+    benchmarkCompileTimeDegree<64>(50'000, 20);
+    benchmarkOrderStatistics(1'000'000, 4);
+    benchmarkOrderStatistics(1'000'000, 32);
+    if (full) {
+        benchmarkLazyDelete(20'000'000, 8);
+        benchmarkBatchOps(50'000'000, 32, 16'000);
+        benchmarkPointLookups(100'000'000, 32);
+        benchmarkBulkLoad(50'000'000, 32);
+        benchmarkNodeAllocators(50'000'000, 8);
+    }
+
     return 0;
 }
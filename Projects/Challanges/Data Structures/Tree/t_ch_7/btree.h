@@ -0,0 +1,1594 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <variant>
+#include "key_rank.h"
+
+using namespace std;
+
+#ifndef UNTITLED2_BTREE_H
+#define UNTITLED2_BTREE_H
+
+//The factor of 2 comes from the maximum size of a node being roughly twice the minimum size (i.e., each node can hold between t−1t−1 and 2t−12t−1 keys).
+//Therefore, the arrays for keys and values must reserve space for up to 2t−12t−1 slots, and the array for children must reserve up to 2t2t slots.
+
+/**
+ * @brief Default node allocator for BTree: hands out fixed-size node blocks from big slabs.
+ *
+ * Every node of a tree has the same size, so instead of one heap allocation per node the
+ * tree owns an arena: blocks are carved off the current slab with a bump pointer, and blocks
+ * that are given back go on a free list (threaded through the freed blocks themselves) to be
+ * reused before the slab is touched again.
+ *
+ * release() returns every slab at once, so a whole tree can be freed in O(#slabs) without
+ * visiting its nodes.
+ */
+class ArenaNodeAllocator {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t blockBytes;          // Size of one node block (a multiple of 'alignment')
+    size_t alignment;           // Alignment of every block and slab
+    size_t blocksPerSlab;       // How many blocks one slab holds
+    vector<char*> slabs;        // Every slab allocated so far
+    char* bump;                 // Next never-used block in the newest slab
+    char* slabEnd;              // End of the newest slab
+    FreeBlock* freeList;        // Blocks given back by deallocate()
+
+public:
+    // release() really frees every block, so the tree may skip walking its nodes
+    static constexpr bool ReleasesAll = true;
+
+    ArenaNodeAllocator(size_t blockBytes, size_t alignment)
+            : blockBytes(max(blockBytes, sizeof(FreeBlock))), alignment(alignment),
+              bump(nullptr), slabEnd(nullptr), freeList(nullptr) {
+        // Aim for slabs of about 256 KiB, but never fewer than 16 nodes per slab
+        blocksPerSlab = max<size_t>(16, (256 * 1024) / this->blockBytes);
+    }
+
+    ArenaNodeAllocator(const ArenaNodeAllocator&) = delete;
+    ArenaNodeAllocator& operator=(const ArenaNodeAllocator&) = delete;
+
+    ~ArenaNodeAllocator() {
+        release();
+    }
+
+    void* allocate() {
+        if (freeList != nullptr) {
+            FreeBlock* block = freeList;
+            freeList = block->next;
+            return block;
+        }
+        if (bump == slabEnd) {
+            char* slab = static_cast<char*>(::operator new(blockBytes * blocksPerSlab, align_val_t(alignment)));
+            slabs.push_back(slab);
+            bump = slab;
+            slabEnd = slab + blockBytes * blocksPerSlab;
+        }
+        void* block = bump;
+        bump += blockBytes;
+        return block;
+    }
+
+    void deallocate(void* block) {
+        FreeBlock* freed = static_cast<FreeBlock*>(block);
+        freed->next = freeList;
+        freeList = freed;
+    }
+
+    void release() {
+        for (char* slab : slabs) {
+            ::operator delete(static_cast<void*>(slab), align_val_t(alignment));
+        }
+        slabs.clear();
+        bump = nullptr;
+        slabEnd = nullptr;
+        freeList = nullptr;
+    }
+};
+
+/**
+ * @brief Node allocator that goes to the global heap for every node (the behaviour before the arena).
+ */
+class HeapNodeAllocator {
+private:
+    size_t blockBytes;
+    size_t alignment;
+
+public:
+    // Nothing is tracked, so every node has to be freed one by one
+    static constexpr bool ReleasesAll = false;
+
+    HeapNodeAllocator(size_t blockBytes, size_t alignment) : blockBytes(blockBytes), alignment(alignment) {}
+
+    void* allocate() {
+        return ::operator new(blockBytes, align_val_t(alignment));
+    }
+
+    void deallocate(void* block) {
+        ::operator delete(block, align_val_t(alignment));
+    }
+
+    void release() {}
+};
+
+/**
+ * @brief Holds a BTree's minimum degree: a compile-time constant when T > 0.
+ *
+ * With a constant 't' every node capacity (2t - 1 keys, 2t children) and every split offset
+ * (t, t - 1) is known to the compiler, so the fixed-length copies in splitChild and the full
+ * checks in insertNonFull compile to straight-line code instead of loops over a runtime count.
+ */
+template <int T>
+struct BTreeDegree {
+    static_assert(T >= 2, "a B-Tree needs a minimum degree of at least 2");
+    static constexpr int t = T;
+
+    explicit BTreeDegree(int) {}
+};
+
+/**
+ * @brief T = 0: the degree is chosen at runtime, in the constructor.
+ */
+template <>
+struct BTreeDegree<0> {
+    int t;
+
+    explicit BTreeDegree(int t) : t(t) {}
+};
+
+/**
+ * @brief BTree class
+ *
+ * A B-Tree of minimum degree `t`. Each node can have up to `2t - 1` keys. Duplicate keys are
+ * allowed. insert() splits full nodes on the way down; remove() deletes in a leaf and fixes
+ * underflow on the way back up, either eagerly (the classic t - 1 minimum) or lazily below a
+ * lower setDeleteThreshold(), with compact() to tighten the tree again.
+ *
+ * Besides point operations (insert, search, find, remove) the tree offers batched lookups and
+ * inserts (findBatch, insertBatch), bulkLoad() from sorted input, ordered traversal with
+ * Cursors (begin, lower_bound, upper_bound), and order statistics when Counted is set.
+ *
+ * @tparam T Minimum degree fixed at compile time, or 0 (the default) to pass it to the constructor.
+ * @tparam Alloc Where node blocks come from. Must be constructible from (blockBytes, alignment)
+ *               and provide allocate(), deallocate(void*), release() and a constexpr ReleasesAll
+ *               telling whether release() alone frees every node. Defaults to a per-tree arena.
+ * @tparam Counted Keep the number of keys under every child pointer, which makes select(),
+ *                 rank() and count() O(log n). Costs 2t counters per node and a little
+ *                 bookkeeping on every insert and remove, so it is off by default.
+ */
+template <typename K, typename V, int T = 0, typename Alloc = ArenaNodeAllocator, bool Counted = false>
+class BTree : private BTreeDegree<T> {
+private:
+    /**
+     * @brief BTreeNode struct
+     *
+     * Each node is one cache-line aligned block of memory:
+     *
+     *   [ header | keys (2t - 1) | children (2t) | counts (2t) | values (2t - 1) ]
+     *
+     * The header holds:
+     * - A boolean flag to indicate if the node is a leaf
+     * - A count of the current number of keys
+     * - Pointers to the three arrays that follow it inside the same block
+     *
+     * The keys come right after the header so the first keys share a cache line with numKeys,
+     * and the children come next because a lookup only needs one child pointer per level.
+     * The values are read only once the key is found, so they sit at the end.
+     *
+     * The counts are only there when the tree is Counted: counts[i] is the number of keys in the
+     * subtree under children[i]. They sit next to the children because select() and rank() read
+     * both on the way down. A leaf's counts are never read.
+     *
+     * Note: In a typical B-Tree, the number of children is always (number_of_keys + 1),
+     *       except for leaf nodes which have 0 children.
+     */
+    struct BTreeNode {
+        bool isLeaf;                 // True if node is leaf
+        int numKeys;                 // Current number of keys stored in this node
+        K* keys;                     // Node's keys
+        BTreeNode** children;        // Child pointers
+        V* values;                   // Values associated with each key
+    };
+
+    static constexpr size_t CacheLine = 64;
+
+    // Lookups findBatch() walks down the tree side by side
+    static constexpr int BatchLanes = 8;
+
+    /**
+     * @brief Cursor over the tree's (key, value) pairs in key order, usable in both directions.
+     *
+     * In a B-Tree the values live in internal nodes as well as leaves, so there is no leaf chain
+     * to follow. Instead the cursor remembers the path from the root to its current key as a
+     * fixed-size stack of (node, index) frames:
+     * - the top frame is the node holding the current key, and 'index' is that key's slot
+     * - every frame below it is an ancestor, and 'index' is the child we went down into
+     *
+     * Moving to the next key is then: go down into the right child and all the way left, or, at
+     * the end of a leaf, pop frames until an ancestor still has a key to the right. Every node is
+     * pushed and popped at most once during a scan, so walking k keys after a lower_bound() costs
+     * O(log n + k) with no recursion and no allocation.
+     *
+     * Like most container iterators, a cursor is invalidated by insert(), remove() and clear().
+     */
+    class Cursor {
+    private:
+        friend class BTree;
+
+        // A B-Tree with t >= 2 and fewer than 2^63 keys is never deeper than this
+        static constexpr int MaxDepth = 64;
+
+        struct Frame {
+            BTreeNode* node;
+            int index;
+        };
+
+        BTreeNode* root;           // Needed to step back from end()
+        Frame stack[MaxDepth];
+        int depth;                 // Number of frames in use; 0 means end()
+
+        explicit Cursor(BTreeNode* root) : root(root), depth(0) {}
+
+        void push(BTreeNode* node, int index) {
+            stack[depth].node = node;
+            stack[depth].index = index;
+            depth++;
+        }
+
+        // Pushes the path to the smallest key under 'node'
+        void descendLeftmost(BTreeNode* node) {
+            while (!node->isLeaf) {
+                push(node, 0);
+                node = node->children[0];
+            }
+            push(node, 0);
+        }
+
+        // Pushes the path to the largest key under 'node'
+        void descendRightmost(BTreeNode* node) {
+            while (!node->isLeaf) {
+                push(node, node->numKeys);
+                node = node->children[node->numKeys];
+            }
+            push(node, node->numKeys - 1);
+        }
+
+        // The top frame is a leaf slot past its last key: climb to the first ancestor that
+        // still has a key to the right of the child we came from (or become end()).
+        // An ancestor's index is the child we came up from, which is also the slot of the
+        // separator key right after that child.
+        void climbToNextKey() {
+            while (depth > 0 && stack[depth - 1].index >= stack[depth - 1].node->numKeys) {
+                depth--;
+            }
+        }
+
+    public:
+        /**
+         * @brief True unless the cursor is at end().
+         */
+        bool valid() const {
+            return depth > 0;
+        }
+
+        const K& key() const {
+            return stack[depth - 1].node->keys[stack[depth - 1].index];
+        }
+
+        V& value() const {
+            return stack[depth - 1].node->values[stack[depth - 1].index];
+        }
+
+        pair<const K&, V&> operator*() const {
+            return {key(), value()};
+        }
+
+        /**
+         * @brief Moves to the next key in order, or to end() after the last one.
+         */
+        Cursor& operator++() {
+            Frame& top = stack[depth - 1];
+            if (!top.node->isLeaf) {
+                // The successor is the smallest key in the right child of the current key
+                top.index++;
+                descendLeftmost(top.node->children[top.index]);
+                return *this;
+            }
+            top.index++;
+            climbToNextKey();
+            return *this;
+        }
+
+        /**
+         * @brief Moves to the previous key in order. Stepping back from end() lands on the largest key.
+         */
+        Cursor& operator--() {
+            if (depth == 0) {
+                if (root != nullptr) {
+                    descendRightmost(root);
+                }
+                return *this;
+            }
+
+            Frame& top = stack[depth - 1];
+            if (!top.node->isLeaf) {
+                // The predecessor is the largest key in the left child of the current key
+                descendRightmost(top.node->children[top.index]);
+                return *this;
+            }
+            if (top.index > 0) {
+                top.index--;
+                return *this;
+            }
+
+            // First key of a leaf: climb to the first ancestor we entered from a child > 0,
+            // the key just left of that child is the predecessor
+            depth--;
+            while (depth > 0 && stack[depth - 1].index == 0) {
+                depth--;
+            }
+            if (depth > 0) {
+                stack[depth - 1].index--;
+            }
+            return *this;
+        }
+
+        bool operator==(const Cursor& other) const {
+            if (depth != other.depth) {
+                return false;
+            }
+            return depth == 0 || (stack[depth - 1].node == other.stack[depth - 1].node &&
+                                  stack[depth - 1].index == other.stack[depth - 1].index);
+        }
+
+        bool operator!=(const Cursor& other) const {
+            return !(*this == other);
+        }
+    };
+
+    BTreeNode* root; // Pointer to the root of the B-Tree
+    using BTreeDegree<T>::t; // Minimum degree (each node can have [t-1 .. 2t-1] keys, except possibly root)
+    int deleteThreshold; // remove() rebalances a node only once it has fewer keys than this
+
+    // Byte offsets of the arrays inside a node block, computed once from 't'
+    size_t keysOffset;
+    size_t childrenOffset;
+    size_t countsOffset;
+    size_t valuesOffset;
+    size_t nodeBytes;
+
+    Alloc alloc;     // Hands out the nodeBytes-sized node blocks
+
+    // --- Utility (Private) Methods ---
+
+    static size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * @brief The subtree key counts of a node, one per child (only meaningful when Counted).
+     */
+    size_t* countsOf(const BTreeNode* node) const {
+        return reinterpret_cast<size_t*>(reinterpret_cast<char*>(const_cast<BTreeNode*>(node)) + countsOffset);
+    }
+
+    /**
+     * @brief Number of keys in the subtree rooted at 'node': its own keys plus its children's counts.
+     */
+    size_t subtreeSize(const BTreeNode* node) const {
+        size_t size = node->numKeys;
+        if (!node->isLeaf) {
+            const size_t* counts = countsOf(node);
+            size = accumulate(counts, counts + node->numKeys + 1, size);
+        }
+        return size;
+    }
+
+    /**
+     * @brief Allocates a node block and constructs its key, child and value arrays in place.
+     *
+     * @param leaf Whether the new node is a leaf.
+     * @return BTreeNode* The new, empty node.
+     */
+    BTreeNode* createNode(bool leaf) {
+        char* block = static_cast<char*>(alloc.allocate());
+
+        BTreeNode* node = new (block) BTreeNode;
+        node->isLeaf = leaf;
+        node->numKeys = 0;
+        node->keys = reinterpret_cast<K*>(block + keysOffset);
+        node->children = reinterpret_cast<BTreeNode**>(block + childrenOffset);
+        node->values = reinterpret_cast<V*>(block + valuesOffset);
+
+        // No-ops for trivially constructible K and V, real constructors for things like std::string
+        uninitialized_default_construct_n(node->keys, 2 * t - 1);
+        uninitialized_value_construct_n(node->children, 2 * t);
+        if constexpr (Counted) {
+            uninitialized_value_construct_n(countsOf(node), 2 * t);
+        }
+        uninitialized_default_construct_n(node->values, 2 * t - 1);
+        return node;
+    }
+
+    /**
+     * @brief Destroys the arrays of a node and gives its block back to the allocator.
+     *
+     * @param node The node to free (its children are not touched).
+     */
+    void destroyNode(BTreeNode* node) {
+        destroy_n(node->keys, 2 * t - 1);
+        destroy_n(node->values, 2 * t - 1);
+        node->~BTreeNode();
+        alloc.deallocate(node);
+    }
+
+    /**
+     * @brief Splits the child of 'parentNode' at index 'childIndex' when it is full.
+     * This is a fundamental operation in B-Trees during insertion.
+     *
+     * @param parentNode The node that has a full child.
+     * @param childIndex The index of the child to split.
+     */
+    void splitChild(BTreeNode* parentNode, int childIndex) {
+        // 1) Grab the child that’s full
+        BTreeNode* fullChild = parentNode->children[childIndex];
+
+        // 2) Create a new node to hold the upper (t - 1) keys of fullChild
+        BTreeNode* newNode = createNode(fullChild->isLeaf);
+
+        // 'mid' is the index of the key that will move up to the parent.
+        // Typically, we promote the (t-1)-th key (0-based index).
+        int mid = t - 1;
+
+        // 3) Copy the top (t - 1) keys and values from fullChild into newNode
+        //    These are the keys after the median. For trivially copyable types
+        //    std::move over a contiguous array compiles down to a memmove.
+        move(fullChild->keys + t, fullChild->keys + t + mid, newNode->keys);
+        move(fullChild->values + t, fullChild->values + t + mid, newNode->values);
+
+        // If the child is not a leaf, copy its top 't' children as well
+        if (!fullChild->isLeaf) {
+            copy(fullChild->children + t, fullChild->children + 2 * t, newNode->children);
+            if constexpr (Counted) {
+                copy(countsOf(fullChild) + t, countsOf(fullChild) + 2 * t, countsOf(newNode));
+            }
+        }
+
+        // 4) Update the numKeys in the new node
+        newNode->numKeys = mid;
+
+        // 5) Reduce the key count in the fullChild (it loses the top half)
+        fullChild->numKeys = mid;
+        // After the split, 'fullChild' keeps [0..(mid-1)] of its keys.
+        // The median key at index 'mid' will move up to the parent.
+
+        // -----------------------------------------------------------------
+        // Move parent’s children to make space for the new child
+        // (We shift everything right by 1 from the back)
+        // -----------------------------------------------------------------
+        copy_backward(parentNode->children + childIndex + 1,
+                      parentNode->children + parentNode->numKeys + 1,
+                      parentNode->children + parentNode->numKeys + 2);
+        parentNode->children[childIndex + 1] = newNode;
+        if constexpr (Counted) {
+            size_t* counts = countsOf(parentNode);
+            copy_backward(counts + childIndex + 1, counts + parentNode->numKeys + 1, counts + parentNode->numKeys + 2);
+            // Recounted rather than derived from the old count, which a brand-new root does not have
+            counts[childIndex]     = subtreeSize(fullChild);
+            counts[childIndex + 1] = subtreeSize(newNode);
+        }
+
+        // -----------------------------------------------------------------
+        // Move parent’s keys/values to make space for the median key
+        // (Shift them right by 1 from the back)
+        // -----------------------------------------------------------------
+        move_backward(parentNode->keys + childIndex,
+                      parentNode->keys + parentNode->numKeys,
+                      parentNode->keys + parentNode->numKeys + 1);
+        move_backward(parentNode->values + childIndex,
+                      parentNode->values + parentNode->numKeys,
+                      parentNode->values + parentNode->numKeys + 1);
+
+        // 6) The median key of fullChild moves up to parent
+        parentNode->keys[childIndex]   = std::move(fullChild->keys[mid]);
+        parentNode->values[childIndex] = std::move(fullChild->values[mid]);
+
+        // 7) The parent now has one more key
+        parentNode->numKeys++;
+    }
+
+    /**
+     * @brief Inserts a key-value pair into a non-full node of the B-Tree.
+     *
+     * @param node The current node where the key is being inserted. This changes as we descend the tree.
+     * @param key The key to insert.
+     * @param value The value to insert.
+    */
+    void insertNonFull(BTreeNode* node, const K& key, const V& value) {
+        // 1) If node is a leaf, insert key/value in sorted position among existing keys.
+        // 2) If node is not a leaf, find the correct child to descend into; if that child is full, split it first, then descend again.
+        if (node->isLeaf) {
+            // The new key goes after every key <= 'key'
+            int pos = KeyRank<K>::upper(node->keys, node->numKeys, key);
+
+            // Shift the larger keys one slot to the right
+            move_backward(node->keys + pos, node->keys + node->numKeys, node->keys + node->numKeys + 1);
+            move_backward(node->values + pos, node->values + node->numKeys, node->values + node->numKeys + 1);
+
+            node->keys[pos]   = key;
+            node->values[pos] = value;
+            node->numKeys++;
+        } else {
+            // Count the keys <= 'key'. That count is exactly the index of the child
+            // whose range contains 'key' (keys equal to a separator go right).
+            int childIndex = KeyRank<K>::upper(node->keys, node->numKeys, key);
+
+            // If that child is full, we split it first.
+            if (node->children[childIndex]->numKeys == (2*t - 1)) {
+                splitChild(node, childIndex);
+
+                // After splitting, one key moves up to the parent,
+                // and the original child is cut in half. We decide
+                // whether to go left or right.
+                if (key > node->keys[childIndex]) {
+                    childIndex++;
+                }
+            }
+
+            // Finally, we insert into that child (recursively).
+            if constexpr (Counted) {
+                countsOf(node)[childIndex]++;
+            }
+            insertNonFull(node->children[childIndex], key, value);
+        }
+    }
+
+    /**
+     * @brief Searches for a key in the subtree rooted at 'node'.
+     *
+     * Walks down one level at a time instead of recursing, so each level costs one
+     * rank computation over that node's contiguous key array plus one child pointer load.
+     * KeyRank picks a SIMD kernel for integer and floating point keys (see key_rank.h).
+     *
+     * @param node The root of the subtree in which to search.
+     * @param key The key to search for.
+     * @return bool True if key is found, false otherwise.
+     */
+    bool searchNode(BTreeNode* node, const K& key) {
+        while (node != nullptr) {
+            // 1) Find the first key in 'node->keys' that is >= key. A binary search would wait for
+            //    each key line it probes in turn, so start loading all of them first.
+            if constexpr (!KeyRank<K>::Vectorized) {
+                prefetchNode(node);
+            }
+            int i = KeyRank<K>::lower(node->keys, node->numKeys, key);
+
+            // 2) If that key == key, return true.
+            if (i < node->numKeys && !(key < node->keys[i])) {
+                return true;
+            }
+
+            // 3) If node is leaf, return false because key not found.
+            if (node->isLeaf) {
+                return false;
+            }
+
+            // 4) Else, continue in the appropriate child.
+            node = node->children[i];
+        }
+        return false;
+    }
+
+    /**
+     * @brief One level of the root-to-leaf path kept by insertBatch().
+     *
+     * 'high' points at the separator right of this node's subtree (the subtree holds keys
+     * below it), or is null for the rightmost subtree of the tree. 'index' is the child the path
+     * goes down into next (unused on the leaf).
+     */
+    struct BatchFrame {
+        BTreeNode* node;
+        const K* high;
+        int index;
+    };
+
+    /**
+     * @brief Walks from the node on top of 'path' down to the leaf for 'key', splitting full children on the way.
+     *
+     * Same descent as insertNonFull, except keys equal to a separator always go right, so that
+     * every frame's 'high' bound is exact for the run of keys that follows.
+     */
+    void descendForBatch(vector<BatchFrame>& path, const K& key) {
+        BTreeNode* node = path.back().node;
+        while (!node->isLeaf) {
+            int childIndex = KeyRank<K>::upper(node->keys, node->numKeys, key);
+            if (node->children[childIndex]->numKeys == 2 * t - 1) {
+                splitChild(node, childIndex);
+                if (!(key < node->keys[childIndex])) {
+                    childIndex++;
+                }
+            }
+            const K* high = childIndex < node->numKeys ? &node->keys[childIndex] : path.back().high;
+            path.back().index = childIndex;
+            node = node->children[childIndex];
+            path.push_back({node, high, 0});
+        }
+    }
+
+    /**
+     * @brief Merges 'count' sorted items into a leaf that has room for them.
+     *
+     * Works from the back so every key moves once. Items go after equal keys already in the
+     * leaf, which is where one insert() per item would have put them.
+     */
+    void mergeIntoLeaf(BTreeNode* leaf, const pair<K, V>* items, int count) {
+        int from = leaf->numKeys - 1;
+        int to = leaf->numKeys + count - 1;
+        for (int next = count - 1; next >= 0; to--) {
+            if (from >= 0 && items[next].first < leaf->keys[from]) {
+                leaf->keys[to]   = std::move(leaf->keys[from]);
+                leaf->values[to] = std::move(leaf->values[from]);
+                from--;
+            } else {
+                leaf->keys[to]   = items[next].first;
+                leaf->values[to] = items[next].second;
+                next--;
+            }
+        }
+        leaf->numKeys += count;
+    }
+
+    /**
+     * @brief Hints the CPU to start loading a node's header and keys, which the next rank reads.
+     */
+    void prefetchNode(const BTreeNode* node) const {
+#if defined(__GNUC__)
+        const char* block = reinterpret_cast<const char*>(node);
+        for (size_t offset = 0; offset < childrenOffset; offset += CacheLine) {
+            __builtin_prefetch(block + offset);
+        }
+#endif
+    }
+
+    /**
+     * @brief Moves the separator keys[i - 1] down into children[i] and the last key of children[i - 1] up in its place.
+     */
+    void borrowFromLeft(BTreeNode* parentNode, int i) {
+        BTreeNode* child = parentNode->children[i];
+        BTreeNode* left = parentNode->children[i - 1];
+
+        // Make room at the front of the child
+        move_backward(child->keys, child->keys + child->numKeys, child->keys + child->numKeys + 1);
+        move_backward(child->values, child->values + child->numKeys, child->values + child->numKeys + 1);
+        child->keys[0]   = std::move(parentNode->keys[i - 1]);
+        child->values[0] = std::move(parentNode->values[i - 1]);
+        size_t moved = 1;
+        if (!child->isLeaf) {
+            copy_backward(child->children, child->children + child->numKeys + 1, child->children + child->numKeys + 2);
+            child->children[0] = left->children[left->numKeys];
+            if constexpr (Counted) {
+                size_t* counts = countsOf(child);
+                copy_backward(counts, counts + child->numKeys + 1, counts + child->numKeys + 2);
+                counts[0] = countsOf(left)[left->numKeys];
+                moved += counts[0];
+            }
+        }
+        child->numKeys++;
+        if constexpr (Counted) {
+            countsOf(parentNode)[i - 1] -= moved;
+            countsOf(parentNode)[i] += moved;
+        }
+
+        parentNode->keys[i - 1]   = std::move(left->keys[left->numKeys - 1]);
+        parentNode->values[i - 1] = std::move(left->values[left->numKeys - 1]);
+        left->numKeys--;
+    }
+
+    /**
+     * @brief Moves the separator keys[i] down into children[i] and the first key of children[i + 1] up in its place.
+     */
+    void borrowFromRight(BTreeNode* parentNode, int i) {
+        BTreeNode* child = parentNode->children[i];
+        BTreeNode* right = parentNode->children[i + 1];
+
+        child->keys[child->numKeys]   = std::move(parentNode->keys[i]);
+        child->values[child->numKeys] = std::move(parentNode->values[i]);
+        size_t moved = 1;
+        if (!child->isLeaf) {
+            child->children[child->numKeys + 1] = right->children[0];
+            if constexpr (Counted) {
+                countsOf(child)[child->numKeys + 1] = countsOf(right)[0];
+                moved += countsOf(right)[0];
+            }
+        }
+        child->numKeys++;
+        if constexpr (Counted) {
+            countsOf(parentNode)[i] += moved;
+            countsOf(parentNode)[i + 1] -= moved;
+        }
+
+        parentNode->keys[i]   = std::move(right->keys[0]);
+        parentNode->values[i] = std::move(right->values[0]);
+
+        // Close the gap at the front of the right sibling
+        move(right->keys + 1, right->keys + right->numKeys, right->keys);
+        move(right->values + 1, right->values + right->numKeys, right->values);
+        if (!right->isLeaf) {
+            copy(right->children + 1, right->children + right->numKeys + 1, right->children);
+            if constexpr (Counted) {
+                copy(countsOf(right) + 1, countsOf(right) + right->numKeys + 1, countsOf(right));
+            }
+        }
+        right->numKeys--;
+    }
+
+    /**
+     * @brief Merges keys[i] and children[i + 1] of 'parentNode' into children[i], and frees children[i + 1].
+     *
+     * The opposite of splitChild. The caller makes sure the result fits in 2t - 1 keys.
+     */
+    void mergeChildren(BTreeNode* parentNode, int i) {
+        BTreeNode* left = parentNode->children[i];
+        BTreeNode* right = parentNode->children[i + 1];
+
+        // The separator comes down between the two halves
+        left->keys[left->numKeys]   = std::move(parentNode->keys[i]);
+        left->values[left->numKeys] = std::move(parentNode->values[i]);
+        move(right->keys, right->keys + right->numKeys, left->keys + left->numKeys + 1);
+        move(right->values, right->values + right->numKeys, left->values + left->numKeys + 1);
+        if (!left->isLeaf) {
+            copy(right->children, right->children + right->numKeys + 1, left->children + left->numKeys + 1);
+            if constexpr (Counted) {
+                copy(countsOf(right), countsOf(right) + right->numKeys + 1, countsOf(left) + left->numKeys + 1);
+            }
+        }
+        left->numKeys += right->numKeys + 1;
+
+        // Close the gap in the parent
+        move(parentNode->keys + i + 1, parentNode->keys + parentNode->numKeys, parentNode->keys + i);
+        move(parentNode->values + i + 1, parentNode->values + parentNode->numKeys, parentNode->values + i);
+        copy(parentNode->children + i + 2, parentNode->children + parentNode->numKeys + 1, parentNode->children + i + 1);
+        if constexpr (Counted) {
+            size_t* counts = countsOf(parentNode);
+            counts[i] += 1 + counts[i + 1];
+            copy(counts + i + 2, counts + parentNode->numKeys + 1, counts + i + 1);
+        }
+        parentNode->numKeys--;
+
+        destroyNode(right);
+    }
+
+    /**
+     * @brief Tops up children[i] of 'parentNode', which has fewer than 'minKeys' keys.
+     *
+     * Borrows one key through the parent from a sibling that can spare one (more than 'minKeys'),
+     * otherwise merges with a sibling. A merge takes a key from the parent, so the parent may
+     * underflow in turn.
+     *
+     * @return int The index of the child that now holds the keys (i, or i - 1 after merging left).
+     */
+    int rebalanceChild(BTreeNode* parentNode, int i, int minKeys) {
+        if (i > 0 && parentNode->children[i - 1]->numKeys > minKeys) {
+            borrowFromLeft(parentNode, i);
+            return i;
+        }
+        if (i < parentNode->numKeys && parentNode->children[i + 1]->numKeys > minKeys) {
+            borrowFromRight(parentNode, i);
+            return i;
+        }
+        if (i < parentNode->numKeys) {
+            mergeChildren(parentNode, i);
+            return i;
+        }
+        mergeChildren(parentNode, i - 1);
+        return i - 1;
+    }
+
+    /**
+     * @brief Removes one occurrence of 'key' from the tree, fixing underflow bottom-up.
+     *
+     * 1) Walk down from the root, remembering every (node, child index) on the way.
+     * 2) If the key sits in an internal node, keep walking to its predecessor (the rightmost key
+     *    of the left subtree), move the predecessor up into the key's slot, and delete the
+     *    predecessor from its leaf instead. Deletes therefore always happen in a leaf.
+     * 3) Walk back up the remembered path. A node is only rebalanced (borrow or merge) when it
+     *    fell below 'deleteThreshold' keys; as soon as one level is fine, the levels above are
+     *    untouched.
+     *
+     * Unlike the top-down textbook delete, nothing is merged "just in case" on the way down.
+     *
+     * @param key The key to remove.
+     * @return bool True if a key was removed.
+     */
+    bool removeNode(const K& key) {
+        typename Cursor::Frame path[Cursor::MaxDepth];
+        int depth = 0;
+
+        // 1) Find the key
+        BTreeNode* node = root;
+        while (true) {
+            int i = KeyRank<K>::lower(node->keys, node->numKeys, key);
+            path[depth++] = {node, i};
+            if (i < node->numKeys && !(key < node->keys[i])) {
+                break;
+            }
+            if (node->isLeaf) {
+                return false;
+            }
+            node = node->children[i];
+        }
+
+        // 2) Swap an internal key with its predecessor, so the delete happens in a leaf
+        if (!node->isLeaf) {
+            int slot = path[depth - 1].index;
+            BTreeNode* leaf = node->children[slot];
+            while (!leaf->isLeaf) {
+                path[depth++] = {leaf, leaf->numKeys};
+                leaf = leaf->children[leaf->numKeys];
+            }
+            path[depth++] = {leaf, leaf->numKeys - 1};
+            node->keys[slot]   = std::move(leaf->keys[leaf->numKeys - 1]);
+            node->values[slot] = std::move(leaf->values[leaf->numKeys - 1]);
+            node = leaf;
+        }
+
+        BTreeNode* leaf = node;
+        int pos = path[depth - 1].index;
+        move(leaf->keys + pos + 1, leaf->keys + leaf->numKeys, leaf->keys + pos);
+        move(leaf->values + pos + 1, leaf->values + leaf->numKeys, leaf->values + pos);
+        leaf->numKeys--;
+        if constexpr (Counted) {
+            // Every frame above the leaf went down into the child that lost the key
+            for (int d = 0; d + 1 < depth; d++) {
+                countsOf(path[d].node)[path[d].index]--;
+            }
+        }
+
+        // 3) Fix underflow on the way back up, stopping at the first level that is fine
+        for (int d = depth - 1; d > 0; d--) {
+            if (path[d].node->numKeys >= deleteThreshold) {
+                break;
+            }
+            rebalanceChild(path[d - 1].node, path[d - 1].index, deleteThreshold);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Restores the full B-Tree minimum (t - 1 keys) in every non-root node below 'node'.
+     *
+     * Post-order: the children are compacted first, then every child that is still short is
+     * topped up from its siblings or merged with them until it has t - 1 keys. A merge can leave
+     * 'node' itself short (even empty), which its own parent fixes one level up.
+     */
+    void compactNode(BTreeNode* node) {
+        if (node->isLeaf) {
+            return;
+        }
+        for (int i = 0; i <= node->numKeys; i++) {
+            compactNode(node->children[i]);
+        }
+        for (int i = 0; i <= node->numKeys; i++) {
+            int index = i;
+            while (node->numKeys > 0 && node->children[index]->numKeys < t - 1) {
+                index = rebalanceChild(node, index, t - 1);
+            }
+        }
+    }
+
+    /**
+     * @brief Drops empty roots, so the tree shrinks by one level after the root's last key is gone.
+     */
+    void shrinkRoot() {
+        while (root != nullptr && root->numKeys == 0) {
+            BTreeNode* oldRoot = root;
+            root = root->isLeaf ? nullptr : root->children[0];
+            destroyNode(oldRoot);
+        }
+    }
+
+    /**
+     * @brief Print in-order traversal of the keys in the subtree rooted at 'node'.
+     *
+     * @param node The subtree root.
+     */
+    void printInOrderNode(BTreeNode* node) {
+        if (node == nullptr) {
+            return;
+        }
+
+        // For each key i in [0..numKeys-1]:
+        //   1) Recursively print the subtree in children[i]
+        //   2) Print key[i]
+        for (int i = 0; i < node->numKeys; i++) {
+            if (!node->isLeaf) {
+                printInOrderNode(node->children[i]);
+            }
+            cout << node->keys[i] << " ";
+        }
+
+        // Print the subtree in children[numKeys] at the end.
+        if (!node->isLeaf) {
+            printInOrderNode(node->children[node->numKeys]);
+        }
+    }
+
+    /**
+     * @brief Deallocates memory for the subtree rooted at 'node'.
+     *
+     * @param node The subtree root to clear.
+     */
+    void clearSubtree(BTreeNode* node) {
+        if (node == nullptr) {
+            return;
+        }
+        if (!node->isLeaf) {
+            for (int i = 0; i <= node->numKeys; i++) {
+                clearSubtree(node->children[i]);
+            }
+        }
+        destroyNode(node);
+    }
+
+    /**
+     * @brief Number of nodes a bulk-loaded level needs so that 'units' are spread as evenly as possible.
+     *
+     * A unit is one child for internal levels, and "one key + 1" for the leaf level (n keys in
+     * L leaves leave exactly L - 1 keys over to act as separators). A node with u units is valid
+     * when t <= u <= 2t, so the count is rounded up from the fill target but never so high that
+     * nodes would drop below t units.
+     *
+     * @param units Total units on the level.
+     * @param unitsPerNode Units each node should get at the requested fill factor.
+     * @return size_t The number of nodes on the level (1 means it is the root).
+     */
+    size_t bulkLoadNodes(size_t units, size_t unitsPerNode) const {
+        size_t nodes = (units + unitsPerNode - 1) / unitsPerNode;
+        return max<size_t>(1, min(nodes, units / t));
+    }
+
+public:
+    /**
+     * @brief Constructor for BTree.
+     *
+     * @param minDegree The minimum degree of the B-Tree. Must be >= 2 for a valid B-Tree.
+     *                  Ignored when the degree is a template argument.
+     */
+    BTree(int minDegree = T)
+            : BTreeDegree<T>(minDegree), root(nullptr), deleteThreshold(t - 1),
+              keysOffset(alignUp(sizeof(BTreeNode), alignof(K))),
+              childrenOffset(alignUp(keysOffset + (2 * t - 1) * sizeof(K), alignof(BTreeNode*))),
+              countsOffset(childrenOffset + 2 * t * sizeof(BTreeNode*)),
+              valuesOffset(alignUp(countsOffset + (Counted ? 2 * t * sizeof(size_t) : 0), alignof(V))),
+              nodeBytes(alignUp(valuesOffset + (2 * t - 1) * sizeof(V), CacheLine)),
+              alloc(nodeBytes, CacheLine) {
+        // Usually, we initialize an empty tree with a single root node that is a leaf.
+        // But you can also keep it as nullptr until the first insertion.
+    }
+
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+    /**
+     * @brief Destructor for BTree. Deallocates all nodes.
+     */
+    ~BTree() {
+        clear();
+    }
+
+    /**
+    * @brief Insert a key-value pair into the B-Tree.
+    *
+    * Steps:
+        *  1) If the root is null, create a new leaf root (store key/value).
+        *  2) If the root is full, split it first.
+            *     - Create a new node as the parent of the old root.
+            *     - Call splitChild(newRoot, 0).
+            *     - Decide if we go left or right child for the insertion.
+     *  3) Otherwise, just call insertNonFull on the existing root.
+    */
+    void insert(const K& key, const V& value) {
+        // 1) If the tree is empty (root == nullptr):
+        if (root == nullptr) {
+            // Create a new root node as a leaf
+            root = createNode(true);
+            root->keys[0] = key;
+            root->values[0] = value;
+            root->numKeys = 1;
+            return; // Done
+        }
+
+        // 2) If the root is full (has 2t - 1 keys), split it before descending
+        if (root->numKeys == (2 * t - 1)) {
+            // Create a new node to become the new root (this new root is not a leaf)
+            BTreeNode* newRoot = createNode(false);
+
+            // The old root becomes newRoot->children[0]
+            newRoot->children[0] = root;
+
+            // Split the old root (child at index 0 of newRoot)
+            splitChild(newRoot, 0);
+
+            // Now decide which child to descend into based on the key
+            int childIndex = 0;
+            if (key > newRoot->keys[0]) {
+                childIndex = 1;
+            }
+
+            // Insert the key into the appropriate child
+            if constexpr (Counted) {
+                countsOf(newRoot)[childIndex]++;
+            }
+            insertNonFull(newRoot->children[childIndex], key, value);
+
+            // newRoot is our actual root now
+            root = newRoot;
+        }
+        else {
+            // 3) If root is not full, just insert into it
+            insertNonFull(root, key, value);
+        }
+    }
+
+    /**
+     * @brief Insert many key-value pairs at once.
+     *
+     * The batch is sorted first, so keys that land in the same leaf sit next to each other.
+     * Each run of such keys is merged into its leaf in one go, and the root-to-leaf path is
+     * kept between runs: the next run climbs only as far as the lowest ancestor whose key range
+     * still contains it (and that has room for a split below it) and descends from there. For
+     * batches that are dense compared to the tree most runs never go back to the root.
+     *
+     * The result is the same tree contents as calling insert() for every item in order.
+     *
+     * @param items The pairs to insert. Sorted in place by key (stable, so equal keys keep
+     *              their order); the pairs themselves are copied into the tree.
+     */
+    void insertBatch(span<pair<K, V>> items) {
+        stable_sort(items.begin(), items.end(),
+                    [](const pair<K, V>& a, const pair<K, V>& b) { return a.first < b.first; });
+
+        vector<BatchFrame> path;
+        size_t next = 0;
+        while (next < items.size()) {
+            const K& key = items[next].first;
+
+            // Climb until the node on top is not full and its range still contains 'key'
+            while (!path.empty() &&
+                   (path.back().node->numKeys == 2 * t - 1 ||
+                    (path.back().high != nullptr && !(key < *path.back().high)))) {
+                path.pop_back();
+            }
+
+            if (path.empty()) {
+                if (root == nullptr) {
+                    root = createNode(true);
+                } else if (root->numKeys == 2 * t - 1) {
+                    BTreeNode* newRoot = createNode(false);
+                    newRoot->children[0] = root;
+                    splitChild(newRoot, 0);
+                    root = newRoot;
+                }
+                path.push_back({root, nullptr, 0});
+            }
+            descendForBatch(path, key);
+
+            // Every following key below the leaf's upper bound belongs here, as long as it fits
+            BTreeNode* leaf = path.back().node;
+            const K* high = path.back().high;
+            size_t room = (2 * t - 1) - leaf->numKeys;
+            size_t runEnd = next;
+            while (runEnd < items.size() && runEnd - next < room &&
+                   (high == nullptr || items[runEnd].first < *high)) {
+                runEnd++;
+            }
+            mergeIntoLeaf(leaf, items.data() + next, static_cast<int>(runEnd - next));
+            if constexpr (Counted) {
+                for (size_t level = 0; level + 1 < path.size(); level++) {
+                    countsOf(path[level].node)[path[level].index] += runEnd - next;
+                }
+            }
+            next = runEnd;
+        }
+    }
+
+
+    /**
+     * @brief Builds the tree bottom-up from a sorted range, replacing whatever it held before.
+     *
+     * Instead of inserting one key at a time (which splits nodes on the way down and leaves them
+     * about half full), the leaves are filled left to right and the internal levels are built on
+     * top of them in the same pass:
+     *  1) From the number of items, work out how many nodes every level gets, so each node holds
+     *     about fillFactor * (2t - 1) keys and no node ends up below t - 1 keys.
+     *  2) Fill a leaf with its share of items.
+     *  3) Hand the finished node to the open node one level up. If that parent still needs more
+     *     children, the next item in the stream becomes the separator key after this child.
+     *     If the parent just got its last child it is finished too, so hand it up the same way.
+     *
+     * Every item is copied exactly once and no node is ever split, so the build is O(n).
+     *
+     * @param first Start of the range of (key, value) pairs, sorted by key. Must be a forward
+     *              iterator because the range is walked once to count it and once to build.
+     * @param last End of the range.
+     * @param fillFactor How full to make each node, in (0, 1]. 1.0 gives the shallowest tree;
+     *                   something lower leaves room for later inserts before nodes split.
+     */
+    template <typename Iterator>
+    void bulkLoad(Iterator first, Iterator last, double fillFactor = 1.0) {
+        clear();
+
+        size_t n = distance(first, last);
+        if (n == 0) {
+            return;
+        }
+
+        // Keys per node we aim for, clamped to what a valid non-root node may hold
+        int targetKeys = clamp(static_cast<int>(fillFactor * (2 * t - 1) + 0.5), t - 1, 2 * t - 1);
+
+        // 1) Plan the levels from the leaves (level 0) up to the root
+        vector<size_t> levelUnits;
+        vector<size_t> levelNodes;
+        size_t units = n + 1;
+        while (true) {
+            size_t nodes = bulkLoadNodes(units, targetKeys + 1);
+            levelUnits.push_back(units);
+            levelNodes.push_back(nodes);
+            if (nodes == 1) {
+                break;
+            }
+            units = nodes;
+        }
+        size_t numLevels = levelNodes.size();
+
+        // Node 'index' of 'level' gets an even share of the level's units
+        auto unitsOf = [&](size_t level, size_t index) {
+            size_t base = levelUnits[level] / levelNodes[level];
+            return base + (index < levelUnits[level] % levelNodes[level] ? 1 : 0);
+        };
+
+        // The internal node currently being filled on each level, and how many of them are done
+        vector<BTreeNode*> open(numLevels, nullptr);
+        vector<size_t> finished(numLevels, 0);
+
+        for (size_t leafIndex = 0; leafIndex < levelNodes[0]; leafIndex++) {
+            // 2) Fill the next leaf
+            BTreeNode* done = createNode(true);
+            int numKeys = static_cast<int>(unitsOf(0, leafIndex)) - 1;
+            for (int i = 0; i < numKeys; i++, ++first) {
+                done->keys[i]   = first->first;
+                done->values[i] = first->second;
+            }
+            done->numKeys = numKeys;
+
+            // 3) Climb while the parent level completes a node
+            size_t level = 0;
+            while (level + 1 < numLevels) {
+                size_t up = level + 1;
+                if (open[up] == nullptr) {
+                    open[up] = createNode(false);
+                }
+                BTreeNode* parent = open[up];
+                int childCount = parent->numKeys + 1;
+                parent->children[childCount - 1] = done;
+                if constexpr (Counted) {
+                    countsOf(parent)[childCount - 1] = subtreeSize(done);
+                }
+
+                if (childCount < static_cast<int>(unitsOf(up, finished[up]))) {
+                    // The parent wants another child, so the next item separates the two
+                    parent->keys[parent->numKeys]   = first->first;
+                    parent->values[parent->numKeys] = first->second;
+                    parent->numKeys++;
+                    ++first;
+                    break;
+                }
+
+                // That was the parent's last child; it is finished and moves up in turn
+                open[up] = nullptr;
+                finished[up]++;
+                done = parent;
+                level = up;
+            }
+
+            if (level + 1 == numLevels) {
+                root = done;
+            }
+        }
+    }
+
+    /**
+     * @brief Number of levels in the tree (0 when empty, 1 when the root is a leaf).
+     */
+    int height() const {
+        int levels = 0;
+        for (BTreeNode* node = root; node != nullptr; node = node->isLeaf ? nullptr : node->children[0]) {
+            levels++;
+        }
+        return levels;
+    }
+
+    /**
+     * @brief Search for a key in the B-Tree.
+     *
+     * @param key The key to search for.
+     * @return bool True if key is found, false otherwise.
+     */
+    bool search(const K& key) {
+        return searchNode(root, key);
+    }
+
+    /**
+     * @brief Look up the value stored for a key.
+     *
+     * @param key The key to search for.
+     * @return V* Pointer to the value, or nullptr if the key is not in the tree. Invalidated by
+     *            insert(), remove() and clear().
+     */
+    V* find(const K& key) {
+        BTreeNode* node = root;
+        while (node != nullptr) {
+            if constexpr (!KeyRank<K>::Vectorized) {
+                prefetchNode(node);
+            }
+            int i = KeyRank<K>::lower(node->keys, node->numKeys, key);
+            if (i < node->numKeys && !(key < node->keys[i])) {
+                return &node->values[i];
+            }
+            node = node->isLeaf ? nullptr : node->children[i];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Look up many keys at once; results[i] gets find(keys[i]).
+     *
+     * A single lookup spends most of its time waiting for each node to arrive from memory, one
+     * level after another. Here lookups run in groups of BatchLanes that walk down the tree side
+     * by side: after a lane picks its child it prefetches that node and the other lanes do their
+     * work while it loads, so the misses of the whole group overlap instead of adding up.
+     * The keys are visited in sorted order, so neighbouring lanes tend to share the upper levels
+     * and the batch walks the tree left to right.
+     *
+     * @param keys The keys to look up.
+     * @param results Receives one value pointer (or nullptr) per key, at the key's position.
+     *                Must be at least as long as 'keys'.
+     */
+    void findBatch(span<const K> keys, span<V*> results) {
+        vector<size_t> order(keys.size());
+        iota(order.begin(), order.end(), size_t(0));
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        for (size_t group = 0; group < order.size(); group += BatchLanes) {
+            int lanes = static_cast<int>(min<size_t>(BatchLanes, order.size() - group));
+            BTreeNode* node[BatchLanes];
+            for (int lane = 0; lane < lanes; lane++) {
+                node[lane] = root;
+                results[order[group + lane]] = nullptr;
+            }
+
+            // One level per pass; a lane drops out when it finds its key or misses in a leaf
+            bool active = root != nullptr;
+            while (active) {
+                active = false;
+                for (int lane = 0; lane < lanes; lane++) {
+                    BTreeNode* current = node[lane];
+                    if (current == nullptr) {
+                        continue;
+                    }
+                    size_t index = order[group + lane];
+                    const K& key = keys[index];
+                    int i = KeyRank<K>::lower(current->keys, current->numKeys, key);
+
+                    if (i < current->numKeys && !(key < current->keys[i])) {
+                        results[index] = &current->values[i];
+                        node[lane] = nullptr;
+                    } else if (current->isLeaf) {
+                        node[lane] = nullptr;
+                    } else {
+                        node[lane] = current->children[i];
+                        prefetchNode(node[lane]);
+                        active = true;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Cursor at the smallest key, or end() if the tree is empty.
+     */
+    Cursor begin() const {
+        Cursor cursor(root);
+        if (root != nullptr && root->numKeys > 0) {
+            cursor.descendLeftmost(root);
+        }
+        return cursor;
+    }
+
+    /**
+     * @brief Cursor one past the largest key.
+     */
+    Cursor end() const {
+        return Cursor(root);
+    }
+
+    /**
+     * @brief Cursor at the first key that is not less than 'key', or end() if there is none.
+     *
+     * Always descends to a leaf instead of stopping at the first equal key, because with
+     * duplicate keys an equal key can also sit in the left subtree of a matching separator.
+     */
+    Cursor lower_bound(const K& key) const {
+        Cursor cursor(root);
+        BTreeNode* node = root;
+        while (node != nullptr) {
+            int i = KeyRank<K>::lower(node->keys, node->numKeys, key);
+            cursor.push(node, i);
+            node = node->isLeaf ? nullptr : node->children[i];
+        }
+        cursor.climbToNextKey();
+        return cursor;
+    }
+
+    /**
+     * @brief Cursor at the first key that is greater than 'key', or end() if there is none.
+     */
+    Cursor upper_bound(const K& key) const {
+        Cursor cursor(root);
+        BTreeNode* node = root;
+        while (node != nullptr) {
+            int i = KeyRank<K>::upper(node->keys, node->numKeys, key);
+            cursor.push(node, i);
+            node = node->isLeaf ? nullptr : node->children[i];
+        }
+        cursor.climbToNextKey();
+        return cursor;
+    }
+
+    /**
+     * @brief Number of keys in the tree, in O(t) from the root's counts. Counted trees only.
+     */
+    size_t size() const {
+        static_assert(Counted, "size() needs a Counted BTree");
+        return root == nullptr ? 0 : subtreeSize(root);
+    }
+
+    /**
+     * @brief Cursor at the k-th smallest key (0-based), or end() if the tree has k keys or fewer.
+     *
+     * Walks down once, skipping whole subtrees by their counts, so it costs O(t log n) no matter
+     * how large k is. Reading a page of rows is select(offset) followed by steps of the cursor.
+     * Counted trees only.
+     */
+    Cursor select(size_t k) const {
+        static_assert(Counted, "select() needs a Counted BTree");
+        Cursor cursor(root);
+        BTreeNode* node = root;
+        while (node != nullptr) {
+            if (node->isLeaf) {
+                if (k < size_t(node->numKeys)) {
+                    cursor.push(node, static_cast<int>(k));
+                    return cursor;
+                }
+                break;
+            }
+
+            // Children and keys alternate in key order: child 0, key 0, child 1, key 1, ...
+            const size_t* counts = countsOf(node);
+            int i = 0;
+            while (i < node->numKeys && k > counts[i]) {
+                k -= counts[i] + 1;
+                i++;
+            }
+            cursor.push(node, i);
+            if (i < node->numKeys && k == counts[i]) {
+                return cursor;
+            }
+            node = node->children[i];
+        }
+        return Cursor(root);
+    }
+
+    /**
+     * @brief Number of keys that are less than 'key', in O(t log n). Counted trees only.
+     *
+     * Every key of a child left of the lower-bound slot is smaller than the separator after it,
+     * so each level adds those children's counts plus the keys in front of the slot.
+     */
+    size_t rank(const K& key) const {
+        static_assert(Counted, "rank() needs a Counted BTree");
+        size_t smaller = 0;
+        BTreeNode* node = root;
+        while (node != nullptr) {
+            int i = KeyRank<K>::lower(node->keys, node->numKeys, key);
+            smaller += i;
+            if (node->isLeaf) {
+                break;
+            }
+            const size_t* counts = countsOf(node);
+            smaller = accumulate(counts, counts + i, smaller);
+            node = node->children[i];
+        }
+        return smaller;
+    }
+
+    /**
+     * @brief Number of keys in [lo, hi), from two rank() walks. Counted trees only.
+     */
+    size_t count(const K& lo, const K& hi) const {
+        if (!(lo < hi)) {
+            return 0;
+        }
+        return rank(hi) - rank(lo);
+    }
+
+    /**
+     * @brief Remove one occurrence of a key from the B-Tree.
+     *
+     * The delete happens in a leaf (an internal key is first replaced by its predecessor), and
+     * underflow is fixed bottom-up along the path: a node is only merged with or topped up from
+     * a sibling once it has fewer than deleteThreshold keys (t - 1 unless changed with
+     * setDeleteThreshold). If the root loses its last key, its only child becomes the new root.
+     *
+     * @param key The key to remove.
+     * @return bool True if the key was found and removed.
+     */
+    bool remove(const K& key) {
+        if (root == nullptr) {
+            return false;
+        }
+        bool removed = removeNode(key);
+        shrinkRoot();
+        return removed;
+    }
+
+    /**
+     * @brief Lets remove() leave nodes with fewer than t - 1 keys.
+     *
+     * With the classic rule every delete that takes a node below t - 1 keys borrows or merges
+     * right away, and a later insert into the merged node may split it again. With a lower
+     * threshold nodes are allowed to run down to 'minKeys' keys first; lookups and inserts work
+     * the same (the tree is just a bit less dense), and compact() restores the classic minimum
+     * whenever that suits the caller, e.g. after a bulk delete or when the workload is idle.
+     *
+     * @param minKeys Fewest keys a non-root node may keep before remove() rebalances it,
+     *                clamped to [1, t - 1]. t - 1 is the classic, eager B-Tree delete.
+     */
+    void setDeleteThreshold(int minKeys) {
+        deleteThreshold = clamp(minKeys, 1, t - 1);
+    }
+
+    /**
+     * @brief Brings every non-root node back up to at least t - 1 keys, merging the nodes that lazy deletes left thin.
+     */
+    void compact() {
+        if (root == nullptr) {
+            return;
+        }
+        compactNode(root);
+        shrinkRoot();
+    }
+
+    /**
+     * @brief Print the B-Tree keys in sorted (in-order) order.
+     */
+    void printInOrder() {
+        printInOrderNode(root);
+        cout << endl;
+    }
+
+    /**
+     * @brief Remove all nodes from the B-Tree, making it empty.
+     *
+     * When the allocator can drop all its blocks at once and the keys and values need no
+     * destructor, the nodes are not visited at all: the cost is O(#slabs), not O(#nodes).
+     */
+    void clear() {
+        if constexpr (!(Alloc::ReleasesAll && is_trivially_destructible_v<K> && is_trivially_destructible_v<V>)) {
+            clearSubtree(root);
+        }
+        alloc.release();
+        root = nullptr;
+    }
+};
+
+/**
+ * @brief B-Tree whose degree is chosen at runtime but that runs compile-time-degree code.
+ *
+ * The common degrees (16, 32, 64, 128) each get their own BTree<K, V, T> instantiation; the
+ * constructor builds the one matching 't', and every call is forwarded to it with std::visit
+ * (one indirect jump per call, while the loops inside use the constant degree). Any other
+ * degree falls back to the runtime-degree BTree<K, V>.
+ *
+ * Cursors depend on the instantiation, so the wrapper offers the point operations only.
+ */
+template <typename K, typename V, typename Alloc = ArenaNodeAllocator>
+class RuntimeDegreeBTree {
+private:
+    using Trees = variant<BTree<K, V, 16, Alloc>, BTree<K, V, 32, Alloc>, BTree<K, V, 64, Alloc>,
+                          BTree<K, V, 128, Alloc>, BTree<K, V, 0, Alloc>>;
+
+    Trees tree;
+
+    // BTree cannot be moved, so the alternative is built in place in the returned variant
+    static Trees makeTree(int t) {
+        switch (t) {
+            case 16:  return Trees(in_place_index<0>);
+            case 32:  return Trees(in_place_index<1>);
+            case 64:  return Trees(in_place_index<2>);
+            case 128: return Trees(in_place_index<3>);
+            default:  return Trees(in_place_index<4>, t);
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor for RuntimeDegreeBTree.
+     *
+     * @param t The minimum degree of the B-Tree. Must be >= 2 for a valid B-Tree.
+     */
+    RuntimeDegreeBTree(int t) : tree(makeTree(t)) {}
+
+    /**
+     * @brief Whether 't' got one of the precompiled degrees (false means the runtime-degree fallback).
+     */
+    bool precompiled() const {
+        return tree.index() != variant_size_v<Trees> - 1;
+    }
+
+    void insert(const K& key, const V& value) {
+        visit([&](auto& tree) { tree.insert(key, value); }, tree);
+    }
+
+    void insertBatch(span<pair<K, V>> items) {
+        visit([&](auto& tree) { tree.insertBatch(items); }, tree);
+    }
+
+    bool search(const K& key) {
+        return visit([&](auto& tree) { return tree.search(key); }, tree);
+    }
+
+    V* find(const K& key) {
+        return visit([&](auto& tree) { return tree.find(key); }, tree);
+    }
+
+    void findBatch(span<const K> keys, span<V*> results) {
+        visit([&](auto& tree) { tree.findBatch(keys, results); }, tree);
+    }
+
+    bool remove(const K& key) {
+        return visit([&](auto& tree) { return tree.remove(key); }, tree);
+    }
+
+    void setDeleteThreshold(int minKeys) {
+        visit([&](auto& tree) { tree.setDeleteThreshold(minKeys); }, tree);
+    }
+
+    void compact() {
+        visit([](auto& tree) { tree.compact(); }, tree);
+    }
+
+    int height() const {
+        return visit([](const auto& tree) { return tree.height(); }, tree);
+    }
+
+    void printInOrder() {
+        visit([](auto& tree) { tree.printInOrder(); }, tree);
+    }
+
+    void clear() {
+        visit([](auto& tree) { tree.clear(); }, tree);
+    }
+};
+
+#endif //UNTITLED2_BTREE_H
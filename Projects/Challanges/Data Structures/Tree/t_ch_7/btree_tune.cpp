@@ -0,0 +1,315 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <unistd.h>
+#include "btree.h"
+
+/*
+ * BTree degree tuner
+ *
+ * The best minimum degree 't' depends on the machine and on sizeof(K) and sizeof(V), and on
+ * how big the tree is compared to the caches:
+ *
+ * - A small node is cheap to search and to split, but a tall tree pays one cache miss per level.
+ * - A big node makes the tree shallow, but every insert shifts about half a node of keys and
+ *   values, and a split copies half a node.
+ *
+ * Once the whole tree fits in L1 or L2 the misses are cheap and small nodes tend to win; once
+ * it lives in DRAM every level costs a miss and bigger nodes win. Where exactly the crossover
+ * is, is a question for the hardware, so this program measures it.
+ *
+ * For each cache level it builds trees of about half that level's size (and one several
+ * times the L3 size, for DRAM), and times, for every degree in the sweep:
+ *
+ *   insert  - building the tree from random keys, ns per key
+ *   lookup  - find() of random present keys, ns per lookup
+ *   scan    - lower_bound() then 1000 steps of the cursor, ns per key
+ *
+ * Each workload's time is divided by the best time any degree got for it, and the degree
+ * with the smallest geometric mean of those three ratios wins the level. The winners are
+ * written to btree_tuned.h as compile-time constants, ready for the BTree's T parameter:
+ *
+ *   BTree<uint64_t, uint64_t, BTreeTuned<uint64_t, uint64_t>::DRAMDegree> tree;
+ *
+ * Usage: btree_tune [quick|full] [output header path]
+ * "full" measures more operations and lets the DRAM tree grow up to 1 GiB (quick: 256 MiB).
+ */
+
+using namespace std;
+
+/**
+ * @brief splitmix64 finalizer, a bijection on 64-bit integers (distinct keys in random order).
+ */
+static uint64_t mixKey(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief 'numKeys' distinct keys of type K in random order.
+ *
+ * mixKey() never repeats, but truncated to a key narrower than 64 bits it does (about 16k
+ * repeats among 11.7M uint32_t keys), and a repeated key would time an extra duplicate entry
+ * instead of a new key. Narrow keys are therefore drawn until there are enough distinct ones,
+ * then shuffled back out of sorted order.
+ */
+template <typename K>
+static vector<K> distinctKeys(size_t numKeys) {
+    vector<K> keys;
+    keys.reserve(numKeys);
+    uint64_t next = 0;
+    while (keys.size() < numKeys) {
+        keys.push_back(K(mixKey(next++)));
+    }
+    if constexpr (sizeof(K) < sizeof(uint64_t)) {
+        for (;;) {
+            sort(keys.begin(), keys.end());
+            keys.erase(unique(keys.begin(), keys.end()), keys.end());
+            if (keys.size() == numKeys) {
+                break;
+            }
+            while (keys.size() < numKeys) {
+                keys.push_back(K(mixKey(next++)));
+            }
+        }
+        shuffle(keys.begin(), keys.end(), mt19937_64(numKeys));
+    }
+    return keys;
+}
+
+static double nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+// Lookup and scan results are added here so the compiler cannot drop the work
+static volatile uint64_t sink;
+
+/**
+ * @brief Size in bytes of one cache level, from sysconf, then sysfs, then a typical default.
+ *
+ * @param level 1 for the L1 data cache, 2 or 3 for the unified caches.
+ */
+size_t cacheBytes(int level) {
+    long bytes = 0;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    bytes = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : level == 2 ? _SC_LEVEL2_CACHE_SIZE : _SC_LEVEL3_CACHE_SIZE);
+#endif
+    if (bytes > 0) {
+        return size_t(bytes);
+    }
+
+    for (int index = 0; index < 8; index++) {
+        string dir = "/sys/devices/system/cpu/cpu0/cache/index" + to_string(index) + "/";
+        ifstream levelFile(dir + "level");
+        ifstream typeFile(dir + "type");
+        ifstream sizeFile(dir + "size");
+        int fileLevel = 0;
+        string type;
+        string size;
+        if (!(levelFile >> fileLevel) || !(typeFile >> type) || !(sizeFile >> size)) {
+            break;
+        }
+        if (fileLevel == level && type != "Instruction") {
+            size_t value = stoul(size);
+            char unit = size.back();
+            return unit == 'K' ? value << 10 : unit == 'M' ? value << 20 : value;
+        }
+    }
+
+    return level == 1 ? 32 << 10 : level == 2 ? 1 << 20 : 32 << 20;
+}
+
+struct Tier {
+    string name;        // "L1", "L2", "L3", "DRAM"
+    size_t treeBytes;   // Rough size the tree is built to
+    bool capped;        // The tree had to be smaller than the level asks for
+};
+
+struct Timing {
+    double insertNanos;
+    double lookupNanos;
+    double scanNanos;
+};
+
+/**
+ * @brief Times the three workloads on a tree of 'numKeys' random keys with minimum degree 'degree'.
+ *
+ * @param minOps Each workload runs at least this many operations, so small trees are timed
+ *               over many rounds.
+ */
+template <typename K, typename V>
+Timing measure(int degree, size_t numKeys, size_t minOps) {
+    vector<K> keys = distinctKeys<K>(numKeys);
+
+    BTree<K, V> tree(degree);
+    Timing timing{};
+
+    // Best of several builds; the last one stays for the lookups and scans
+    size_t rounds = max<size_t>(3, minOps / numKeys);
+    timing.insertNanos = 1e300;
+    for (size_t round = 0; round < rounds; round++) {
+        tree.clear();
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < numKeys; i++) {
+            tree.insert(keys[i], V(i));
+        }
+        timing.insertNanos = min(timing.insertNanos, nanosSince(start) / numKeys);
+    }
+
+    mt19937_64 rng(degree);
+    vector<K> probes(min<size_t>(minOps, 1 << 22));
+    for (K& probe : probes) {
+        probe = keys[rng() % numKeys];
+    }
+
+    uint64_t sum = 0;
+    size_t lookups = 0;
+    auto start = chrono::steady_clock::now();
+    while (lookups < minOps) {
+        for (const K& probe : probes) {
+            sum += uint64_t(*tree.find(probe));
+        }
+        lookups += probes.size();
+    }
+    timing.lookupNanos = nanosSince(start) / lookups;
+
+    const size_t scanLength = 1000;
+    size_t scanned = 0;
+    start = chrono::steady_clock::now();
+    for (size_t s = 0; scanned < minOps; s++) {
+        auto cursor = tree.lower_bound(probes[s % probes.size()]);
+        for (size_t i = 0; i < scanLength && cursor.valid(); i++, ++cursor) {
+            sum += uint64_t(cursor.value());
+            scanned++;
+        }
+    }
+    timing.scanNanos = nanosSince(start) / max<size_t>(scanned, 1);
+
+    sink = sink + sum;
+    return timing;
+}
+
+/**
+ * @brief Runs the sweep for one K/V pair and returns the winning degree per tier.
+ */
+template <typename K, typename V>
+vector<int> tune(const string& typeName, const vector<Tier>& tiers, const vector<int>& degrees, size_t minOps) {
+    // About 1/0.7 of a key, value and child pointer per key: random inserts leave nodes ~70% full
+    const double bytesPerKey = (sizeof(K) + sizeof(V) + sizeof(void*)) / 0.7;
+
+    cout << "== " << typeName << " ==" << endl;
+    vector<int> winners;
+    for (const Tier& tier : tiers) {
+        size_t numKeys = max<size_t>(256, size_t(tier.treeBytes / bytesPerKey));
+        cout << tier.name << " (" << numKeys << " keys, ~" << (tier.treeBytes >> 10) << " KiB"
+             << (tier.capped ? ", capped" : "") << ")" << endl;
+
+        vector<Timing> timings;
+        for (int degree : degrees) {
+            timings.push_back(measure<K, V>(degree, numKeys, minOps));
+        }
+
+        Timing best{1e300, 1e300, 1e300};
+        for (const Timing& timing : timings) {
+            best.insertNanos = min(best.insertNanos, timing.insertNanos);
+            best.lookupNanos = min(best.lookupNanos, timing.lookupNanos);
+            best.scanNanos = min(best.scanNanos, timing.scanNanos);
+        }
+
+        int winner = degrees[0];
+        double winnerScore = 1e300;
+        for (size_t d = 0; d < degrees.size(); d++) {
+            const Timing& timing = timings[d];
+            double score = cbrt(timing.insertNanos / best.insertNanos * (timing.lookupNanos / best.lookupNanos) *
+                                (timing.scanNanos / best.scanNanos));
+            cout << "  t = " << degrees[d] << ":\tinsert " << timing.insertNanos << " ns\tlookup "
+                 << timing.lookupNanos << " ns\tscan " << timing.scanNanos << " ns/key\tscore " << score << endl;
+            if (score < winnerScore) {
+                winnerScore = score;
+                winner = degrees[d];
+            }
+        }
+        cout << "  best: t = " << winner << endl;
+        winners.push_back(winner);
+    }
+    return winners;
+}
+
+/**
+ * @brief The BTreeTuned specialization for one K/V pair, as it goes into the header.
+ */
+string tunedSpecialization(const string& typeName, const vector<Tier>& tiers, const vector<int>& winners) {
+    ostringstream out;
+    out << "template <>\n";
+    out << "struct BTreeTuned<" << typeName << "> {\n";
+    for (size_t i = 0; i < tiers.size(); i++) {
+        out << "    static constexpr int " << tiers[i].name << "Degree = " << winners[i] << ";   // trees up to ~"
+            << (tiers[i].treeBytes >> 10) << " KiB" << (tiers[i].capped ? " (capped, measured smaller)" : "") << "\n";
+    }
+    out << "};\n";
+    return out.str();
+}
+
+int main(int argc, char* argv[]) {
+    bool full = argc > 1 && string(argv[1]) == "full";
+    string outputPath = argc > 2 ? argv[2] : "btree_tuned.h";
+
+    size_t l1 = cacheBytes(1);
+    size_t l2 = cacheBytes(2);
+    size_t l3 = cacheBytes(3);
+    size_t maxTreeBytes = full ? size_t(1) << 30 : size_t(256) << 20;
+    size_t minOps = full ? 10'000'000 : 2'000'000;
+    cout << "caches: L1 " << (l1 >> 10) << " KiB, L2 " << (l2 >> 10) << " KiB, L3 " << (l3 >> 10) << " KiB" << endl;
+
+    vector<Tier> tiers = {
+            {"L1", l1 / 2, false},
+            {"L2", l2 / 2, false},
+            {"L3", l3 / 2, false},
+            {"DRAM", max<size_t>(4 * l3, size_t(64) << 20), false},
+    };
+    for (Tier& tier : tiers) {
+        if (tier.treeBytes > maxTreeBytes) {
+            tier.treeBytes = maxTreeBytes;
+            tier.capped = true;
+        }
+    }
+
+    vector<int> degrees = {4, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+    vector<int> wide = tune<uint64_t, uint64_t>("uint64_t, uint64_t", tiers, degrees, minOps);
+    vector<int> narrow = tune<uint32_t, uint32_t>("uint32_t, uint32_t", tiers, degrees, minOps);
+
+    ofstream header(outputPath);
+    header << "// Generated by btree_tune.cpp (" << (full ? "full" : "quick") << " run) on a machine with L1 "
+           << (l1 >> 10) << " KiB, L2 " << (l2 >> 10) << " KiB, L3 " << (l3 >> 10) << " KiB.\n"
+           << "// Rerun it on the target machine instead of editing these numbers by hand.\n"
+           << "#include <cstdint>\n"
+           << "\n"
+           << "#ifndef UNTITLED2_BTREE_TUNED_H\n"
+           << "#define UNTITLED2_BTREE_TUNED_H\n"
+           << "\n"
+           << "/**\n"
+           << " * @brief Measured best BTree minimum degree per K/V pair, by how big the tree is compared to the caches.\n"
+           << " *\n"
+           << " * Usage: BTree<uint64_t, uint64_t, BTreeTuned<uint64_t, uint64_t>::DRAMDegree> tree;\n"
+           << " */\n"
+           << "template <typename K, typename V>\n"
+           << "struct BTreeTuned;\n"
+           << "\n"
+           << tunedSpecialization("uint64_t, uint64_t", tiers, wide)
+           << "\n"
+           << tunedSpecialization("uint32_t, uint32_t", tiers, narrow)
+           << "\n"
+           << "#endif //UNTITLED2_BTREE_TUNED_H\n";
+    cout << "wrote " << outputPath << endl;
+
+    return 0;
+}
@@ -0,0 +1,657 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "btree.h"
+
+/*
+ * Disk-backed B-Tree
+ *
+ * btree.txt explains why B-Trees exist: a node is sized to one disk block, so the height of the
+ * tree - and therefore the number of block reads per lookup - stays tiny. The BTree in btree.h
+ * keeps every node on the heap, so the index disappears when the program exits and has to fit
+ * in RAM.
+ *
+ * Here every node is one page of a file (4 KiB or 16 KiB), and a child "pointer" is the
+ * number of the page it lives on:
+ *
+ *   page 0        meta page: magic, page size, key/value sizes, degree, root page, page count
+ *   page 1..n-1   nodes:     [ isLeaf | numKeys | keys... | children (page ids)... | values... ]
+ *
+ * The file is accessed through mmap, so the operating system's page cache is the node cache:
+ * a page is only read from disk the first time it is touched, and dirty pages are written back
+ * by the kernel (or by sync()). Opening an existing tree only reads the meta page, no matter how
+ * big the tree is.
+ *
+ * One large region of address space is reserved up front and the file is mapped into it, so
+ * page addresses never move while the file grows (the file itself is grown with ftruncate).
+ * Mapping past the end of the file is allowed; touching those pages is not, and the tree only
+ * touches pages below the page count.
+ *
+ * The pages at the top of the tree are read by every single lookup. A small pool pins the
+ * most recently used internal pages in RAM with mlock, so memory pressure never pushes them out
+ * to disk; if the process may not lock memory it falls back to madvise(MADV_WILLNEED).
+ *
+ * Keys and values are stored as raw bytes in the file, so they must be trivially copyable, and
+ * a file must be reopened with the same K, V and page size. There is no write-ahead log: a crash
+ * in the middle of a split can leave the file inconsistent.
+ */
+
+using namespace std;
+
+/**
+ * @brief Keeps the most recently used pages of a mapping locked in RAM.
+ */
+class PagePinPool {
+private:
+    size_t pageSize;
+    size_t capacity;
+    bool useMlock;
+
+    list<char*> recent;                                   // Front is the most recently used
+    unordered_map<char*, list<char*>::iterator> pinned;
+
+    void pin(char* page) {
+        if (useMlock && mlock(page, pageSize) != 0) {
+            // Usually RLIMIT_MEMLOCK: stop trying and only hint the kernel from now on
+            useMlock = false;
+        }
+        if (!useMlock) {
+            madvise(page, pageSize, MADV_WILLNEED);
+        }
+    }
+
+    void unpin(char* page) {
+        if (useMlock) {
+            munlock(page, pageSize);
+        }
+    }
+
+public:
+    PagePinPool(size_t pageSize, size_t capacity) : pageSize(pageSize), capacity(capacity), useMlock(true) {}
+
+    PagePinPool(const PagePinPool&) = delete;
+    PagePinPool& operator=(const PagePinPool&) = delete;
+
+    ~PagePinPool() {
+        clear();
+    }
+
+    /**
+     * @brief Marks 'page' as used, pinning it and unpinning the least recently used page if needed.
+     */
+    void touch(char* page) {
+        auto found = pinned.find(page);
+        if (found != pinned.end()) {
+            recent.splice(recent.begin(), recent, found->second);
+            return;
+        }
+        if (capacity == 0) {
+            return;
+        }
+        if (recent.size() == capacity) {
+            unpin(recent.back());
+            pinned.erase(recent.back());
+            recent.pop_back();
+        }
+        pin(page);
+        recent.push_front(page);
+        pinned[page] = recent.begin();
+    }
+
+    /**
+     * @brief Unpins every page.
+     */
+    void clear() {
+        for (char* page : recent) {
+            unpin(page);
+        }
+        recent.clear();
+        pinned.clear();
+    }
+
+    size_t size() const {
+        return recent.size();
+    }
+};
+
+/**
+ * @brief B-Tree stored in a file, one node per page, accessed through mmap.
+ *
+ * Same insert/search algorithms as BTree (preemptive split on the way down, SIMD rank inside a
+ * node), but nodes are addressed by page number and survive the process.
+ *
+ * @tparam K Key type, must be trivially copyable.
+ * @tparam V Value type, must be trivially copyable.
+ */
+template <typename K, typename V>
+class DiskBTree {
+private:
+    static_assert(is_trivially_copyable_v<K> && is_trivially_copyable_v<V>,
+                  "keys and values are stored in the file as raw bytes");
+
+    using PageId = uint32_t;
+
+    static constexpr uint64_t Magic = 0x3145455254425044ULL;   // "DPBTREE1"
+    static constexpr uint32_t FormatVersion = 1;
+
+    /**
+     * @brief Layout of page 0.
+     */
+    struct MetaPage {
+        uint64_t magic;
+        uint32_t formatVersion;
+        uint32_t pageSize;
+        uint32_t keySize;
+        uint32_t valueSize;
+        int32_t t;
+        PageId root;                 // 0 while the tree is empty
+        PageId pageCount;            // Pages in use, including the meta page
+        uint64_t numKeys;
+    };
+
+    /**
+     * @brief Header at the start of every node page.
+     */
+    struct PageHeader {
+        uint32_t isLeaf;
+        int32_t numKeys;
+    };
+
+    /**
+     * @brief A node page with its arrays located, the on-disk counterpart of BTree::BTreeNode.
+     */
+    struct PageNode {
+        PageHeader* header;
+        K* keys;
+        PageId* children;
+        V* values;
+    };
+
+    int fd;
+    char* base;                  // Start of the reserved mapping, never moves
+    size_t reservedBytes;
+    size_t pageSize;
+    size_t fileBytes;
+    int t;
+
+    size_t keysOffset;
+    size_t childrenOffset;
+    size_t valuesOffset;
+
+    PagePinPool pool;
+
+    static size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    MetaPage* meta() const {
+        return reinterpret_cast<MetaPage*>(base);
+    }
+
+    char* pageAddress(PageId id) const {
+        return base + static_cast<size_t>(id) * pageSize;
+    }
+
+    PageNode node(PageId id) const {
+        char* page = pageAddress(id);
+        return PageNode{reinterpret_cast<PageHeader*>(page),
+                        reinterpret_cast<K*>(page + keysOffset),
+                        reinterpret_cast<PageId*>(page + childrenOffset),
+                        reinterpret_cast<V*>(page + valuesOffset)};
+    }
+
+    /**
+     * @brief Largest t whose 2t - 1 keys, 2t children and 2t - 1 values fit in one page.
+     */
+    static int degreeForPage(size_t pageSize) {
+        size_t fixed = alignUp(sizeof(PageHeader), alignof(K)) + sizeof(PageId) + alignof(PageId) + alignof(V);
+        size_t perKey = sizeof(K) + sizeof(PageId) + sizeof(V);
+        size_t maxKeys = (pageSize - fixed) / perKey;
+        return static_cast<int>((maxKeys + 1) / 2);
+    }
+
+    /**
+     * @brief Validates t and lays out a node page for it.
+     */
+    void checkDegree() {
+        if (t < 2) {
+            throw invalid_argument("minimum degree must be at least 2");
+        }
+        keysOffset = alignUp(sizeof(PageHeader), alignof(K));
+        childrenOffset = alignUp(keysOffset + (2 * static_cast<size_t>(t) - 1) * sizeof(K), alignof(PageId));
+        valuesOffset = alignUp(childrenOffset + 2 * static_cast<size_t>(t) * sizeof(PageId), alignof(V));
+        if (valuesOffset + (2 * static_cast<size_t>(t) - 1) * sizeof(V) > pageSize) {
+            throw invalid_argument("degree too large for the page size");
+        }
+    }
+
+    /**
+     * @brief Unmaps and closes a half-opened file unless release() is called.
+     */
+    struct OpenGuard {
+        int& fd;
+        char*& base;
+        size_t reservedBytes;
+        bool armed = true;
+
+        void release() {
+            armed = false;
+        }
+
+        ~OpenGuard() {
+            if (!armed) {
+                return;
+            }
+            if (base != nullptr) {
+                munmap(base, reservedBytes);
+                base = nullptr;
+            }
+            close(fd);
+            fd = -1;
+        }
+    };
+
+    void growFile(size_t bytes) {
+        if (bytes > reservedBytes) {
+            throw length_error("disk B-Tree is larger than its reserved address range");
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            throw runtime_error("cannot grow B-Tree file");
+        }
+        fileBytes = bytes;
+    }
+
+    /**
+     * @brief Takes the next page at the end of the file, doubling the file when it is full.
+     */
+    PageId allocatePage(bool leaf) {
+        MetaPage* header = meta();
+        PageId id = header->pageCount;
+        size_t needed = (static_cast<size_t>(id) + 1) * pageSize;
+        if (needed > fileBytes) {
+            if (needed > reservedBytes) {
+                throw length_error("disk B-Tree is larger than its reserved address range");
+            }
+            // Only the doubling is clamped; the page itself always fits after the check above
+            growFile(max(needed, min(fileBytes * 2, reservedBytes)));
+        }
+        header->pageCount++;
+
+        PageNode created = node(id);
+        created.header->isLeaf = leaf ? 1 : 0;
+        created.header->numKeys = 0;
+        return id;
+    }
+
+    /**
+     * @brief Splits the full child at 'childIndex' of 'parentId', same steps as BTree::splitChild.
+     */
+    void splitChild(PageId parentId, int childIndex) {
+        PageNode parentNode = node(parentId);
+        PageId fullId = parentNode.children[childIndex];
+        PageId newId = allocatePage(node(fullId).header->isLeaf != 0);
+        PageNode fullChild = node(fullId);
+        PageNode newNode = node(newId);
+        int mid = t - 1;
+
+        copy(fullChild.keys + t, fullChild.keys + t + mid, newNode.keys);
+        copy(fullChild.values + t, fullChild.values + t + mid, newNode.values);
+        if (!fullChild.header->isLeaf) {
+            copy(fullChild.children + t, fullChild.children + 2 * t, newNode.children);
+        }
+        newNode.header->numKeys = mid;
+        fullChild.header->numKeys = mid;
+
+        int parentKeys = parentNode.header->numKeys;
+        copy_backward(parentNode.children + childIndex + 1,
+                      parentNode.children + parentKeys + 1,
+                      parentNode.children + parentKeys + 2);
+        parentNode.children[childIndex + 1] = newId;
+        copy_backward(parentNode.keys + childIndex, parentNode.keys + parentKeys, parentNode.keys + parentKeys + 1);
+        copy_backward(parentNode.values + childIndex, parentNode.values + parentKeys, parentNode.values + parentKeys + 1);
+        parentNode.keys[childIndex] = fullChild.keys[mid];
+        parentNode.values[childIndex] = fullChild.values[mid];
+        parentNode.header->numKeys++;
+    }
+
+    /**
+     * @brief Inserts into the subtree at 'id', which is not full. Iterative version of BTree::insertNonFull.
+     */
+    void insertNonFull(PageId id, const K& key, const V& value) {
+        while (true) {
+            PageNode current = node(id);
+            int numKeys = current.header->numKeys;
+
+            if (current.header->isLeaf) {
+                int pos = KeyRank<K>::upper(current.keys, numKeys, key);
+                copy_backward(current.keys + pos, current.keys + numKeys, current.keys + numKeys + 1);
+                copy_backward(current.values + pos, current.values + numKeys, current.values + numKeys + 1);
+                current.keys[pos] = key;
+                current.values[pos] = value;
+                current.header->numKeys++;
+                return;
+            }
+
+            pool.touch(pageAddress(id));
+            int childIndex = KeyRank<K>::upper(current.keys, numKeys, key);
+            if (node(current.children[childIndex]).header->numKeys == 2 * t - 1) {
+                splitChild(id, childIndex);
+                if (key > current.keys[childIndex]) {
+                    childIndex++;
+                }
+            }
+            id = current.children[childIndex];
+        }
+    }
+
+    void printInOrderNode(PageId id) const {
+        PageNode current = node(id);
+        for (int i = 0; i < current.header->numKeys; i++) {
+            if (!current.header->isLeaf) {
+                printInOrderNode(current.children[i]);
+            }
+            cout << current.keys[i] << " ";
+        }
+        if (!current.header->isLeaf) {
+            printInOrderNode(current.children[current.header->numKeys]);
+        }
+    }
+
+public:
+    /**
+     * @brief Opens the tree stored in 'path', or creates an empty one if the file is empty or missing.
+     *
+     * @param path File that holds the tree.
+     * @param pageSize Node size in bytes, 4096 or 16384. Must match when reopening.
+     * @param t Minimum degree for a new tree; 0 picks the largest degree that fits a page.
+     * @param pinnedPages How many internal pages to keep locked in RAM.
+     * @param reservedBytes Address space reserved for the mapping, the largest the file may grow.
+     */
+    DiskBTree(const string& path, size_t pageSize = 4096, int t = 0, size_t pinnedPages = 256,
+              size_t reservedBytes = size_t(64) << 30)
+            : fd(-1), base(nullptr), reservedBytes(reservedBytes), pageSize(pageSize), fileBytes(0), t(t),
+              keysOffset(0), childrenOffset(0), valuesOffset(0), pool(pageSize, pinnedPages) {
+        if (pageSize != 4096 && pageSize != 16384) {
+            throw invalid_argument("page size must be 4096 or 16384");
+        }
+        // Reject a bad degree before the file is touched, so no meta page is written with it
+        if (this->t == 0) {
+            this->t = degreeForPage(pageSize);
+        }
+        checkDegree();
+
+        fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw runtime_error("cannot open B-Tree file " + path);
+        }
+        // Until the constructor finishes, every throw below has to give back the mapping and the descriptor
+        OpenGuard guard{fd, base, reservedBytes};
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            throw runtime_error("cannot stat B-Tree file " + path);
+        }
+        fileBytes = static_cast<size_t>(info.st_size);
+        if (fileBytes > reservedBytes) {
+            throw length_error("B-Tree file " + path + " is larger than the reserved address range");
+        }
+
+        void* mapped = mmap(nullptr, reservedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            throw runtime_error("cannot map B-Tree file " + path);
+        }
+        base = static_cast<char*>(mapped);
+
+        if (fileBytes == 0) {
+            // New file: write the meta page
+            growFile(16 * pageSize);
+            MetaPage* header = meta();
+            header->magic = Magic;
+            header->formatVersion = FormatVersion;
+            header->pageSize = static_cast<uint32_t>(pageSize);
+            header->keySize = sizeof(K);
+            header->valueSize = sizeof(V);
+            header->t = this->t;
+            header->root = 0;
+            header->pageCount = 1;
+            header->numKeys = 0;
+        } else {
+            MetaPage* header = meta();
+            if (fileBytes < pageSize || header->magic != Magic || header->formatVersion != FormatVersion ||
+                header->pageSize != pageSize || header->keySize != sizeof(K) || header->valueSize != sizeof(V)) {
+                throw runtime_error("file " + path + " does not hold a B-Tree of this type");
+            }
+            // Pages past the end of the file would fault on first access instead of failing here
+            if (header->pageCount == 0 || header->pageCount > fileBytes / pageSize ||
+                header->root >= header->pageCount) {
+                throw runtime_error("B-Tree file " + path + " is truncated or corrupt");
+            }
+            this->t = header->t;
+            checkDegree();
+        }
+        guard.release();
+    }
+
+    DiskBTree(const DiskBTree&) = delete;
+    DiskBTree& operator=(const DiskBTree&) = delete;
+
+    /**
+     * @brief Flushes every page to the file and unmaps it.
+     */
+    ~DiskBTree() {
+        pool.clear();
+        sync();
+        munmap(base, reservedBytes);
+        close(fd);
+    }
+
+    /**
+     * @brief Writes all modified pages back to the file and waits until they are on disk.
+     */
+    void sync() {
+        msync(base, static_cast<size_t>(meta()->pageCount) * pageSize, MS_SYNC);
+    }
+
+    /**
+     * @brief Insert a key-value pair into the B-Tree.
+     */
+    void insert(const K& key, const V& value) {
+        MetaPage* header = meta();
+        if (header->root == 0) {
+            header->root = allocatePage(true);
+        }
+
+        PageId rootId = header->root;
+        if (node(rootId).header->numKeys == 2 * t - 1) {
+            // Root is full, the tree grows one level
+            PageId newRoot = allocatePage(false);
+            node(newRoot).children[0] = rootId;
+            splitChild(newRoot, 0);
+            header->root = newRoot;
+            rootId = newRoot;
+        }
+        insertNonFull(rootId, key, value);
+        header->numKeys++;
+    }
+
+    /**
+     * @brief Search for a key in the B-Tree.
+     *
+     * @param key The key to search for.
+     * @param value If not null, receives the value when the key is found.
+     * @return bool True if key is found, false otherwise.
+     */
+    bool search(const K& key, V* value = nullptr) {
+        PageId id = meta()->root;
+        while (id != 0) {
+            PageNode current = node(id);
+            int numKeys = current.header->numKeys;
+            int i = KeyRank<K>::lower(current.keys, numKeys, key);
+
+            if (i < numKeys && !(key < current.keys[i])) {
+                if (value != nullptr) {
+                    *value = current.values[i];
+                }
+                return true;
+            }
+            if (current.header->isLeaf) {
+                return false;
+            }
+            pool.touch(pageAddress(id));
+            id = current.children[i];
+        }
+        return false;
+    }
+
+    /**
+     * @brief Print all keys in sorted order.
+     */
+    void printInOrder() const {
+        if (meta()->root != 0) {
+            printInOrderNode(meta()->root);
+        }
+        cout << endl;
+    }
+
+    uint64_t size() const {
+        return meta()->numKeys;
+    }
+
+    int degree() const {
+        return t;
+    }
+
+    size_t pages() const {
+        return meta()->pageCount;
+    }
+
+    int height() const {
+        int levels = 0;
+        for (PageId id = meta()->root; id != 0; levels++) {
+            PageNode current = node(id);
+            id = current.header->isLeaf ? 0 : current.children[0];
+        }
+        return levels;
+    }
+};
+
+// --- Benchmark ---
+
+/**
+ * @brief splitmix64 finalizer, a bijection on 64-bit integers (distinct keys in random order).
+ */
+static uint64_t mixKey(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Build a tree on disk, reopen it, and compare lookups against the in-memory BTree.
+ */
+void benchmarkDiskTree(size_t numKeys, size_t pageSize) {
+    string path = (filesystem::temp_directory_path() / "disk_btree_bench.db").string();
+    filesystem::remove(path);
+
+    cout << numKeys << " keys, " << pageSize << " byte pages" << endl;
+
+    auto start = chrono::steady_clock::now();
+    {
+        DiskBTree<uint64_t, uint64_t> tree(path, pageSize);
+        for (size_t i = 0; i < numKeys; i++) {
+            tree.insert(mixKey(i), i);
+        }
+        cout << "  build: " << secondsSince(start) << " s, t = " << tree.degree() << ", height "
+             << tree.height() << ", " << tree.pages() * pageSize / (1 << 20) << " MiB" << endl;
+    }
+    cout << "  build + sync + close: " << secondsSince(start) << " s" << endl;
+
+    start = chrono::steady_clock::now();
+    DiskBTree<uint64_t, uint64_t> reopened(path, pageSize);
+    cout << "  reopen: " << secondsSince(start) * 1e6 << " us, " << reopened.size() << " keys" << endl;
+
+    BTree<uint64_t, uint64_t> memory(reopened.degree());
+    for (size_t i = 0; i < numKeys; i++) {
+        memory.insert(mixKey(i), i);
+    }
+
+    mt19937_64 rng(42);
+    vector<uint64_t> probes(1'000'000);
+    for (uint64_t& probe : probes) {
+        probe = mixKey(rng() % numKeys);
+    }
+
+    size_t found = 0;
+    start = chrono::steady_clock::now();
+    for (uint64_t probe : probes) {
+        found += memory.search(probe);
+    }
+    double memoryNanos = secondsSince(start) * 1e9 / probes.size();
+
+    start = chrono::steady_clock::now();
+    for (uint64_t probe : probes) {
+        found += reopened.search(probe);
+    }
+    double diskNanos = secondsSince(start) * 1e9 / probes.size();
+
+    cout << "  lookups: in-memory BTree " << memoryNanos << " ns, disk BTree " << diskNanos
+         << " ns (found " << found << ")" << endl;
+
+    filesystem::remove(path);
+}
+
+int main(int argc, char* argv[]) {
+    string path = (filesystem::temp_directory_path() / "disk_btree_demo.db").string();
+    filesystem::remove(path);
+
+    {
+        DiskBTree<int, int> tree(path, 4096, 2);
+        for (int key : {10, 20, 5, 6, 12, 30, 7, 17}) {
+            tree.insert(key, key * 100);
+        }
+        cout << "In-order traversal: ";
+        tree.printInOrder();
+    }
+
+    // Everything above is in the file now
+    DiskBTree<int, int> reopened(path, 4096);
+    cout << "Reopened, " << reopened.size() << " keys: ";
+    reopened.printInOrder();
+
+    int value = 0;
+    if (reopened.search(12, &value)) {
+        cout << "Found key 12 with value " << value << endl;
+    }
+    if (!reopened.search(15)) {
+        cout << "Key 15 not found" << endl;
+    }
+    filesystem::remove(path);
+
+    // Pass "full" for a tree much bigger than the page cache budget of a small machine
+    bool full = argc > 1 && string(argv[1]) == "full";
+    benchmarkDiskTree(1'000'000, 4096);
+    benchmarkDiskTree(1'000'000, 16384);
+    if (full) {
+        benchmarkDiskTree(200'000'000, 16384);
+    }
+
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+#ifndef UNTITLED2_KEY_RANK_H
+#define UNTITLED2_KEY_RANK_H
+
+/*
+ * Rank-in-node kernels for B-Tree nodes.
+ *
+ * A node keeps its keys sorted in one contiguous array, so "where does 'key' go in this node"
+ * is just a count:
+ *   lower(keys, n, key) = number of keys <  key  (index of the first key >= key)
+ *   upper(keys, n, key) = number of keys <= key  (index of the child to descend into)
+ *
+ * For integer and floating point keys the count is done with SIMD compares: every key in a
+ * register is compared against the needle at once, and every matching lane adds one to a
+ * per-lane counter. There are no data dependent branches, so a node of
+ * 2t - 1 keys costs (2t - 1) / lanes compares instead of a mispredicted linear or binary search.
+ *
+ * Which ISA is used is decided at compile time by the usual predefined macros:
+ *   __AVX2__   -> 8 x 32-bit, 4 x 64-bit, 16 x 16-bit keys per compare
+ *   __SSE4_2__ -> 2 x 64-bit keys per compare (SSE2 has no 64-bit integer compare)
+ *   __SSE2__   -> 4 x 32-bit, 8 x 16-bit keys per compare (always on for x86-64)
+ * Build with -march=native (or -mavx2) to get the AVX2 path. Whatever is left over is counted
+ * with a plain loop. Any other key type, or a key width without SIMD support in this build,
+ * falls back to a binary search.
+ */
+
+// Which key widths have a SIMD kernel in this build
+#if defined(__SSE2__)
+constexpr bool SimdRank32 = true;   // 16-bit and 32-bit integers, float, double
+#else
+constexpr bool SimdRank32 = false;
+#endif
+#if defined(__SSE4_2__)
+constexpr bool SimdRank64 = true;   // 64-bit integers
+#else
+constexpr bool SimdRank64 = false;
+#endif
+
+#if defined(__SSE2__)
+// Horizontal sums of the per-lane counters the kernels below accumulate
+inline int sumLanes16(__m128i acc) {
+    acc = _mm_add_epi16(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi16(acc, _mm_shuffle_epi32(acc, 0xB1));
+    acc = _mm_add_epi16(acc, _mm_srli_epi32(acc, 16));
+    return static_cast<int16_t>(_mm_cvtsi128_si32(acc));
+}
+
+inline int sumLanes32(__m128i acc) {
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+    return _mm_cvtsi128_si32(acc);
+}
+
+inline int sumLanes64(__m128i acc) {
+    acc = _mm_add_epi64(acc, _mm_shuffle_epi32(acc, 0x4E));
+    return static_cast<int>(_mm_cvtsi128_si32(acc));
+}
+#endif
+
+#if defined(__AVX2__)
+inline __m128i foldLanes16(__m256i acc) {
+    return _mm_add_epi16(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+}
+
+inline __m128i foldLanes32(__m256i acc) {
+    return _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+}
+
+inline __m128i foldLanes64(__m256i acc) {
+    return _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+}
+#endif
+
+/*
+ * Each kernel below counts the keys that are less than (Greater = false) or greater than
+ * (Greater = true) 'key'. A SIMD compare yields -1 in every lane that matched, so subtracting
+ * the compare result from an accumulator adds one per match; the lanes are summed once at the end.
+ *
+ * Unsigned keys are passed in as their signed twin together with 'flip' set to the sign bit;
+ * flipping the sign bit of both sides lets the signed SIMD compares order them correctly.
+ */
+template <bool Greater, typename Lane>
+inline int countCompare16(const Lane* keys, int n, Lane key, make_unsigned_t<Lane> flip) {
+    int count = 0;
+    int i = 0;
+    const Lane needleKey = static_cast<Lane>(static_cast<make_unsigned_t<Lane>>(key) ^ flip);
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    const __m256i flip256 = _mm256_set1_epi16(static_cast<int16_t>(flip));
+    const __m256i needle256 = _mm256_set1_epi16(needleKey);
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 16 <= n; i += 16) {
+        __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip256);
+        acc256 = _mm256_sub_epi16(acc256, Greater ? _mm256_cmpgt_epi16(block, needle256) : _mm256_cmpgt_epi16(needle256, block));
+    }
+    acc = foldLanes16(acc256);
+#endif
+    const __m128i flip128 = _mm_set1_epi16(static_cast<int16_t>(flip));
+    const __m128i needle128 = _mm_set1_epi16(needleKey);
+    for (; i + 8 <= n; i += 8) {
+        __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip128);
+        acc = _mm_sub_epi16(acc, Greater ? _mm_cmpgt_epi16(block, needle128) : _mm_cmpgt_epi16(needle128, block));
+    }
+    count = sumLanes16(acc);
+#endif
+    for (; i < n; i++) {
+        Lane k = static_cast<Lane>(static_cast<make_unsigned_t<Lane>>(keys[i]) ^ flip);
+        count += Greater ? (k > needleKey) : (k < needleKey);
+    }
+    return count;
+}
+
+template <bool Greater, typename Lane>
+inline int countCompare32(const Lane* keys, int n, Lane key, make_unsigned_t<Lane> flip) {
+    int count = 0;
+    int i = 0;
+    const Lane needleKey = static_cast<Lane>(static_cast<make_unsigned_t<Lane>>(key) ^ flip);
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    const __m256i flip256 = _mm256_set1_epi32(static_cast<int32_t>(flip));
+    const __m256i needle256 = _mm256_set1_epi32(needleKey);
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip256);
+        acc256 = _mm256_sub_epi32(acc256, Greater ? _mm256_cmpgt_epi32(block, needle256) : _mm256_cmpgt_epi32(needle256, block));
+    }
+    acc = foldLanes32(acc256);
+#endif
+    const __m128i flip128 = _mm_set1_epi32(static_cast<int32_t>(flip));
+    const __m128i needle128 = _mm_set1_epi32(needleKey);
+    for (; i + 4 <= n; i += 4) {
+        __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip128);
+        acc = _mm_sub_epi32(acc, Greater ? _mm_cmpgt_epi32(block, needle128) : _mm_cmpgt_epi32(needle128, block));
+    }
+    count = sumLanes32(acc);
+#endif
+    for (; i < n; i++) {
+        Lane k = static_cast<Lane>(static_cast<make_unsigned_t<Lane>>(keys[i]) ^ flip);
+        count += Greater ? (k > needleKey) : (k < needleKey);
+    }
+    return count;
+}
+
+template <bool Greater, typename Lane>
+inline int countCompare64(const Lane* keys, int n, Lane key, make_unsigned_t<Lane> flip) {
+    int count = 0;
+    int i = 0;
+    const Lane needleKey = static_cast<Lane>(static_cast<make_unsigned_t<Lane>>(key) ^ flip);
+#if defined(__SSE4_2__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    const __m256i flip256 = _mm256_set1_epi64x(static_cast<int64_t>(flip));
+    const __m256i needle256 = _mm256_set1_epi64x(needleKey);
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip256);
+        acc256 = _mm256_sub_epi64(acc256, Greater ? _mm256_cmpgt_epi64(block, needle256) : _mm256_cmpgt_epi64(needle256, block));
+    }
+    acc = foldLanes64(acc256);
+#endif
+    const __m128i flip128 = _mm_set1_epi64x(static_cast<int64_t>(flip));
+    const __m128i needle128 = _mm_set1_epi64x(needleKey);
+    for (; i + 2 <= n; i += 2) {
+        __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip128);
+        acc = _mm_sub_epi64(acc, Greater ? _mm_cmpgt_epi64(block, needle128) : _mm_cmpgt_epi64(needle128, block));
+    }
+    count = sumLanes64(acc);
+#endif
+    for (; i < n; i++) {
+        Lane k = static_cast<Lane>(static_cast<make_unsigned_t<Lane>>(keys[i]) ^ flip);
+        count += Greater ? (k > needleKey) : (k < needleKey);
+    }
+    return count;
+}
+
+template <bool Greater>
+inline int countCompareFloat(const float* keys, int n, float key) {
+    int count = 0;
+    int i = 0;
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    const __m256 needle256 = _mm256_set1_ps(key);
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256 block = _mm256_loadu_ps(keys + i);
+        __m256 mask = Greater ? _mm256_cmp_ps(block, needle256, _CMP_GT_OQ) : _mm256_cmp_ps(block, needle256, _CMP_LT_OQ);
+        acc256 = _mm256_sub_epi32(acc256, _mm256_castps_si256(mask));
+    }
+    acc = foldLanes32(acc256);
+#endif
+    const __m128 needle128 = _mm_set1_ps(key);
+    for (; i + 4 <= n; i += 4) {
+        __m128 block = _mm_loadu_ps(keys + i);
+        __m128 mask = Greater ? _mm_cmpgt_ps(block, needle128) : _mm_cmplt_ps(block, needle128);
+        acc = _mm_sub_epi32(acc, _mm_castps_si128(mask));
+    }
+    count = sumLanes32(acc);
+#endif
+    for (; i < n; i++) {
+        count += Greater ? (keys[i] > key) : (keys[i] < key);
+    }
+    return count;
+}
+
+template <bool Greater>
+inline int countCompareDouble(const double* keys, int n, double key) {
+    int count = 0;
+    int i = 0;
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    const __m256d needle256 = _mm256_set1_pd(key);
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256d block = _mm256_loadu_pd(keys + i);
+        __m256d mask = Greater ? _mm256_cmp_pd(block, needle256, _CMP_GT_OQ) : _mm256_cmp_pd(block, needle256, _CMP_LT_OQ);
+        acc256 = _mm256_sub_epi64(acc256, _mm256_castpd_si256(mask));
+    }
+    acc = foldLanes64(acc256);
+#endif
+    const __m128d needle128 = _mm_set1_pd(key);
+    for (; i + 2 <= n; i += 2) {
+        __m128d block = _mm_loadu_pd(keys + i);
+        __m128d mask = Greater ? _mm_cmpgt_pd(block, needle128) : _mm_cmplt_pd(block, needle128);
+        acc = _mm_sub_epi64(acc, _mm_castpd_si128(mask));
+    }
+    count = sumLanes64(acc);
+#endif
+    for (; i < n; i++) {
+        count += Greater ? (keys[i] > key) : (keys[i] < key);
+    }
+    return count;
+}
+
+/**
+ * @brief Rank of a key inside one sorted node, picked at compile time from the key type.
+ *
+ * The primary template is the scalar fallback used for every key type without a SIMD kernel
+ * (strings, pairs, user types): a binary search that only needs operator<.
+ */
+template <typename K, typename Enable = void>
+struct KeyRank {
+    static constexpr bool Vectorized = false;
+
+    static int lower(const K* keys, int n, const K& key) {
+        return static_cast<int>(lower_bound(keys, keys + n, key) - keys);
+    }
+
+    static int upper(const K* keys, int n, const K& key) {
+        return static_cast<int>(upper_bound(keys, keys + n, key) - keys);
+    }
+};
+
+/**
+ * @brief 16, 32 and 64-bit integer keys, when this build has a SIMD kernel for their width.
+ */
+template <typename K>
+struct KeyRank<K, enable_if_t<is_integral_v<K> && !is_same_v<K, bool> &&
+                              (((sizeof(K) == 2 || sizeof(K) == 4) && SimdRank32) ||
+                               (sizeof(K) == 8 && SimdRank64))>> {
+    static constexpr bool Vectorized = true;
+
+    using Lane = make_signed_t<K>;
+    using Bits = make_unsigned_t<K>;
+    static constexpr Bits Flip = is_unsigned_v<K> ? static_cast<Bits>(numeric_limits<Lane>::min()) : 0;
+
+    template <bool Greater>
+    static int count(const K* keys, int n, K key) {
+        const Lane* lanes = reinterpret_cast<const Lane*>(keys);
+        if constexpr (sizeof(K) == 2) {
+            return countCompare16<Greater>(lanes, n, static_cast<Lane>(key), Flip);
+        } else if constexpr (sizeof(K) == 4) {
+            return countCompare32<Greater>(lanes, n, static_cast<Lane>(key), Flip);
+        } else {
+            return countCompare64<Greater>(lanes, n, static_cast<Lane>(key), Flip);
+        }
+    }
+
+    static int lower(const K* keys, int n, const K& key) {
+        return count<false>(keys, n, key);
+    }
+
+    static int upper(const K* keys, int n, const K& key) {
+        return n - count<true>(keys, n, key);
+    }
+};
+
+/**
+ * @brief float and double keys (NaN keys are not supported, just like with std::sort).
+ */
+template <typename K>
+struct KeyRank<K, enable_if_t<(is_same_v<K, float> || is_same_v<K, double>) && SimdRank32>> {
+    static constexpr bool Vectorized = true;
+
+    template <bool Greater>
+    static int count(const K* keys, int n, K key) {
+        if constexpr (is_same_v<K, float>) {
+            return countCompareFloat<Greater>(keys, n, key);
+        } else {
+            return countCompareDouble<Greater>(keys, n, key);
+        }
+    }
+
+    static int lower(const K* keys, int n, const K& key) {
+        return count<false>(keys, n, key);
+    }
+
+    static int upper(const K* keys, int n, const K& key) {
+        return n - count<true>(keys, n, key);
+    }
+};
+
+#endif //UNTITLED2_KEY_RANK_H
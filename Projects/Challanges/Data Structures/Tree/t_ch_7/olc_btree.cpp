@@ -0,0 +1,530 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include "btree.h"
+
+/*
+ * Optimistic Lock Coupling (OLC)
+ *
+ * The plain BTree is single threaded, so the usual way to share it is one mutex around the
+ * whole tree, and then every lookup waits for every other lookup.
+ *
+ * With optimistic lock coupling every node carries a version counter instead of a lock:
+ *
+ *   version:  [ ...counter... | locked bit | obsolete bit ]
+ *
+ * - A reader never writes anything. It remembers the version of a node before reading it and
+ *   checks afterwards that the version did not change. If it changed, a writer was in there
+ *   and whatever the reader saw may be garbage, so it restarts from the root.
+ * - A writer locks a node by setting the locked bit with a compare-and-swap from the version it
+ *   read, so the lock only succeeds if nobody changed the node in between. Unlocking bumps
+ *   the counter, which makes every reader that overlapped the write restart.
+ *
+ * "Coupling" is how the descent moves from parent to child: read the child pointer, check the
+ * parent is unchanged (so the pointer is real), read the child's version, and check the
+ * parent once more (so the child was not split while we grabbed its version).
+ *
+ * Insertion keeps the preemptive split of BTree::insertNonFull: whenever the descent meets a
+ * full node it locks that node and its parent (only those two), splits, and restarts. The
+ * leaf that finally receives the key is therefore never full, and at most two nodes are
+ * ever locked by one writer.
+ *
+ * Readers may copy keys and values while a writer is changing them; those copies are thrown
+ * away when validation fails. That is only harmless for trivially copyable K and V, so the
+ * class insists on them. (Thread sanitizer reports these reads as races; that is the point
+ * of the scheme.) Nodes are never freed while the tree is alive, because a split keeps the
+ * old node, so a reader holding a stale pointer always points at valid memory.
+ */
+
+using namespace std;
+
+/**
+ * @brief Concurrent B-Tree using optimistic lock coupling.
+ *
+ * Any number of threads may call insert() and search() at the same time.
+ *
+ * @tparam K Key type, must be trivially copyable.
+ * @tparam V Value type, must be trivially copyable.
+ */
+template <typename K, typename V>
+class OLCBTree {
+private:
+    static_assert(is_trivially_copyable_v<K> && is_trivially_copyable_v<V>,
+                  "optimistic readers copy keys and values that may be changing under them");
+
+    static constexpr uint64_t LockedBit = 2;
+    static constexpr uint64_t ObsoleteBit = 1;
+    static constexpr size_t CacheLine = 64;
+
+    /**
+     * @brief Same one-block layout as BTree's node, plus a version word in the header.
+     */
+    struct OLCNode {
+        atomic<uint64_t> version;    // Counter, locked and obsolete bits
+        atomic<int> numKeys;         // Current number of keys stored in this node
+        bool isLeaf;                 // Never changes after the node is created
+        K* keys;
+        OLCNode** children;
+        V* values;
+    };
+
+    atomic<OLCNode*> root;
+    int t;
+
+    size_t keysOffset;
+    size_t childrenOffset;
+    size_t valuesOffset;
+    size_t nodeBytes;
+
+    static size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    OLCNode* createNode(bool leaf) {
+        char* block = static_cast<char*>(::operator new(nodeBytes, align_val_t(CacheLine)));
+        OLCNode* node = new (block) OLCNode;
+        node->version.store(0, memory_order_relaxed);
+        node->numKeys.store(0, memory_order_relaxed);
+        node->isLeaf = leaf;
+        node->keys = reinterpret_cast<K*>(block + keysOffset);
+        node->children = reinterpret_cast<OLCNode**>(block + childrenOffset);
+        node->values = reinterpret_cast<V*>(block + valuesOffset);
+        uninitialized_value_construct_n(node->children, 2 * t);
+        return node;
+    }
+
+    void clearSubtree(OLCNode* node) {
+        if (node == nullptr) {
+            return;
+        }
+        if (!node->isLeaf) {
+            for (int i = 0; i <= node->numKeys.load(memory_order_relaxed); i++) {
+                clearSubtree(node->children[i]);
+            }
+        }
+        node->~OLCNode();
+        ::operator delete(static_cast<void*>(node), align_val_t(CacheLine));
+    }
+
+    // --- Version protocol ---
+
+    /**
+     * @brief Starts an optimistic read of 'node'.
+     *
+     * @param needRestart Set when the node is locked or obsolete right now.
+     * @return uint64_t The version to validate against later.
+     */
+    static uint64_t readLockOrRestart(OLCNode* node, bool& needRestart) {
+        uint64_t version = node->version.load(memory_order_acquire);
+        if ((version & (LockedBit | ObsoleteBit)) != 0) {
+            needRestart = true;
+        }
+        return version;
+    }
+
+    /**
+     * @brief Checks that nothing changed 'node' since 'version' was read.
+     */
+    static void checkOrRestart(OLCNode* node, uint64_t version, bool& needRestart) {
+        // Keep the data reads above from being moved below the version re-read
+        atomic_thread_fence(memory_order_acquire);
+        if (node->version.load(memory_order_relaxed) != version) {
+            needRestart = true;
+        }
+    }
+
+    /**
+     * @brief Ends an optimistic read. Same check as checkOrRestart, named for where it is used.
+     */
+    static void readUnlockOrRestart(OLCNode* node, uint64_t version, bool& needRestart) {
+        checkOrRestart(node, version, needRestart);
+    }
+
+    /**
+     * @brief Turns an optimistic read into a write lock, if nobody wrote the node since 'version'.
+     */
+    static void upgradeToWriteLockOrRestart(OLCNode* node, uint64_t version, bool& needRestart) {
+        if (!node->version.compare_exchange_strong(version, version + LockedBit, memory_order_acquire)) {
+            needRestart = true;
+            return;
+        }
+        // The writes that follow must not become visible before the locked bit
+        atomic_thread_fence(memory_order_release);
+    }
+
+    /**
+     * @brief Clears the locked bit and bumps the counter, so overlapping readers restart.
+     */
+    static void writeUnlock(OLCNode* node) {
+        node->version.fetch_add(LockedBit, memory_order_release);
+    }
+
+    // Number of keys as seen by an optimistic reader, kept inside the arrays even if torn
+    int readNumKeys(OLCNode* node) const {
+        return clamp(node->numKeys.load(memory_order_relaxed), 0, 2 * t - 1);
+    }
+
+    static void backoff(int restarts) {
+        if (restarts > 8) {
+            this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Splits the full child at 'childIndex' of 'parentNode'. Both must be write locked
+     * (or, for a brand new root, not yet visible to other threads).
+     */
+    void splitChild(OLCNode* parentNode, int childIndex) {
+        OLCNode* fullChild = parentNode->children[childIndex];
+        OLCNode* newNode = createNode(fullChild->isLeaf);
+        int mid = t - 1;
+        int parentKeys = parentNode->numKeys.load(memory_order_relaxed);
+
+        copy(fullChild->keys + t, fullChild->keys + t + mid, newNode->keys);
+        copy(fullChild->values + t, fullChild->values + t + mid, newNode->values);
+        if (!fullChild->isLeaf) {
+            copy(fullChild->children + t, fullChild->children + 2 * t, newNode->children);
+        }
+        newNode->numKeys.store(mid, memory_order_relaxed);
+        fullChild->numKeys.store(mid, memory_order_relaxed);
+
+        copy_backward(parentNode->children + childIndex + 1,
+                      parentNode->children + parentKeys + 1,
+                      parentNode->children + parentKeys + 2);
+        parentNode->children[childIndex + 1] = newNode;
+        copy_backward(parentNode->keys + childIndex, parentNode->keys + parentKeys, parentNode->keys + parentKeys + 1);
+        copy_backward(parentNode->values + childIndex, parentNode->values + parentKeys, parentNode->values + parentKeys + 1);
+        parentNode->keys[childIndex] = fullChild->keys[mid];
+        parentNode->values[childIndex] = fullChild->values[mid];
+        parentNode->numKeys.store(parentKeys + 1, memory_order_relaxed);
+    }
+
+public:
+    /**
+     * @brief Constructor for OLCBTree.
+     *
+     * @param t The minimum degree of the B-Tree. Must be >= 2 for a valid B-Tree.
+     */
+    OLCBTree(int t)
+            : t(t),
+              keysOffset(alignUp(sizeof(OLCNode), alignof(K))),
+              childrenOffset(alignUp(keysOffset + (2 * t - 1) * sizeof(K), alignof(OLCNode*))),
+              valuesOffset(alignUp(childrenOffset + 2 * t * sizeof(OLCNode*), alignof(V))),
+              nodeBytes(alignUp(valuesOffset + (2 * t - 1) * sizeof(V), CacheLine)) {
+        // Unlike BTree the root always exists, so readers never have to handle a null root
+        root.store(createNode(true), memory_order_relaxed);
+    }
+
+    OLCBTree(const OLCBTree&) = delete;
+    OLCBTree& operator=(const OLCBTree&) = delete;
+
+    /**
+     * @brief Destructor. No other thread may be using the tree any more.
+     */
+    ~OLCBTree() {
+        clearSubtree(root.load(memory_order_relaxed));
+    }
+
+    /**
+     * @brief Insert a key-value pair. Safe to call from many threads at once.
+     *
+     * Walks down like BTree::insertNonFull. A full node on the way is split right away,
+     * with only that node and its parent write locked, and the insert then starts over.
+     */
+    void insert(const K& key, const V& value) {
+        int restarts = 0;
+    restart:
+        backoff(restarts++);
+        bool needRestart = false;
+
+        OLCNode* node = root.load(memory_order_acquire);
+        uint64_t version = readLockOrRestart(node, needRestart);
+        if (needRestart || node != root.load(memory_order_acquire)) {
+            goto restart;
+        }
+
+        OLCNode* parent = nullptr;
+        uint64_t parentVersion = 0;
+        int childIndex = 0;
+
+        while (true) {
+            if (node->numKeys.load(memory_order_relaxed) == 2 * t - 1) {
+                // Full node: lock the parent and the node, split, and start over
+                if (parent != nullptr) {
+                    upgradeToWriteLockOrRestart(parent, parentVersion, needRestart);
+                    if (needRestart) {
+                        goto restart;
+                    }
+                }
+                upgradeToWriteLockOrRestart(node, version, needRestart);
+                if (needRestart) {
+                    if (parent != nullptr) {
+                        writeUnlock(parent);
+                    }
+                    goto restart;
+                }
+
+                if (parent == nullptr) {
+                    // Splitting the root: the root pointer only changes while the old root is
+                    // locked, so holding that lock makes this check safe
+                    if (node != root.load(memory_order_acquire)) {
+                        writeUnlock(node);
+                        goto restart;
+                    }
+                    OLCNode* newRoot = createNode(false);
+                    newRoot->children[0] = node;
+                    splitChild(newRoot, 0);
+                    root.store(newRoot, memory_order_release);
+                } else {
+                    splitChild(parent, childIndex);
+                    writeUnlock(parent);
+                }
+                writeUnlock(node);
+                goto restart;
+            }
+
+            // The node has room, so the parent is not needed any more
+            if (parent != nullptr) {
+                readUnlockOrRestart(parent, parentVersion, needRestart);
+                if (needRestart) {
+                    goto restart;
+                }
+            }
+
+            if (node->isLeaf) {
+                upgradeToWriteLockOrRestart(node, version, needRestart);
+                if (needRestart) {
+                    goto restart;
+                }
+                int numKeys = node->numKeys.load(memory_order_relaxed);
+                int pos = KeyRank<K>::upper(node->keys, numKeys, key);
+                copy_backward(node->keys + pos, node->keys + numKeys, node->keys + numKeys + 1);
+                copy_backward(node->values + pos, node->values + numKeys, node->values + numKeys + 1);
+                node->keys[pos] = key;
+                node->values[pos] = value;
+                node->numKeys.store(numKeys + 1, memory_order_relaxed);
+                writeUnlock(node);
+                return;
+            }
+
+            childIndex = KeyRank<K>::upper(node->keys, readNumKeys(node), key);
+            OLCNode* child = node->children[childIndex];
+            checkOrRestart(node, version, needRestart);
+            if (needRestart) {
+                goto restart;
+            }
+
+            parent = node;
+            parentVersion = version;
+            node = child;
+            version = readLockOrRestart(node, needRestart);
+            if (needRestart) {
+                goto restart;
+            }
+        }
+    }
+
+    /**
+     * @brief Look up a key without taking any lock. Safe to call from many threads at once.
+     *
+     * @param key The key to search for.
+     * @param value If not null, receives a copy of the value when the key is found.
+     * @return bool True if key is found, false otherwise.
+     */
+    bool search(const K& key, V* value = nullptr) const {
+        int restarts = 0;
+    restart:
+        backoff(restarts++);
+        bool needRestart = false;
+
+        OLCNode* node = root.load(memory_order_acquire);
+        uint64_t version = readLockOrRestart(node, needRestart);
+        if (needRestart || node != root.load(memory_order_acquire)) {
+            goto restart;
+        }
+
+        while (true) {
+            int numKeys = readNumKeys(node);
+            int i = KeyRank<K>::lower(node->keys, numKeys, key);
+
+            if (i < numKeys && !(key < node->keys[i])) {
+                V found = node->values[i];
+                readUnlockOrRestart(node, version, needRestart);
+                if (needRestart) {
+                    goto restart;
+                }
+                if (value != nullptr) {
+                    *value = found;
+                }
+                return true;
+            }
+            if (node->isLeaf) {
+                readUnlockOrRestart(node, version, needRestart);
+                if (needRestart) {
+                    goto restart;
+                }
+                return false;
+            }
+
+            // Lock coupling: validate the parent before using the child pointer, and again
+            // after reading the child's version, so a split of the child in between is noticed
+            OLCNode* child = node->children[i];
+            checkOrRestart(node, version, needRestart);
+            if (needRestart) {
+                goto restart;
+            }
+            uint64_t childVersion = readLockOrRestart(child, needRestart);
+            if (needRestart) {
+                goto restart;
+            }
+            readUnlockOrRestart(node, version, needRestart);
+            if (needRestart) {
+                goto restart;
+            }
+            node = child;
+            version = childVersion;
+        }
+    }
+};
+
+// --- Benchmark ---
+
+/**
+ * @brief splitmix64 finalizer, a bijection on 64-bit integers (distinct keys in random order).
+ */
+static uint64_t mixKey(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief The setup the OLC tree replaces: a plain BTree behind one global mutex.
+ */
+class LockedBTree {
+private:
+    BTree<uint64_t, uint64_t> tree;
+    mutable mutex treeMutex;
+
+public:
+    LockedBTree(int t) : tree(t) {}
+
+    void insert(uint64_t key, uint64_t value) {
+        lock_guard<mutex> guard(treeMutex);
+        tree.insert(key, value);
+    }
+
+    bool search(uint64_t key) const {
+        lock_guard<mutex> guard(treeMutex);
+        return const_cast<BTree<uint64_t, uint64_t>&>(tree).search(key);
+    }
+};
+
+/**
+ * @brief Runs a mixed workload on 'tree' from 'numThreads' threads and returns million ops/s.
+ *
+ * Every thread does 'opsPerThread' operations: 90% lookups of keys that were preloaded and 10%
+ * inserts of new keys from a range only that thread uses.
+ */
+template <typename Tree>
+double mixedThroughput(Tree& tree, size_t preloaded, int numThreads, size_t opsPerThread) {
+    atomic<size_t> misses{0};
+    vector<thread> threads;
+
+    auto start = chrono::steady_clock::now();
+    for (int id = 0; id < numThreads; id++) {
+        threads.emplace_back([&, id]() {
+            mt19937_64 rng(id + 1);
+            uint64_t nextInsert = preloaded + static_cast<uint64_t>(id) * opsPerThread;
+            size_t localMisses = 0;
+            for (size_t op = 0; op < opsPerThread; op++) {
+                if (rng() % 10 == 0) {
+                    tree.insert(mixKey(nextInsert), nextInsert);
+                    nextInsert++;
+                } else if (!tree.search(mixKey(rng() % preloaded))) {
+                    localMisses++;
+                }
+            }
+            misses += localMisses;
+        });
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (misses != 0) {
+        cout << "  lost keys: " << misses << endl;
+    }
+    return numThreads * opsPerThread / seconds / 1e6;
+}
+
+/**
+ * @brief Mixed read/insert throughput at 1, 4, 16 and 64 threads, global mutex vs OLC.
+ */
+void benchmarkMixedWorkload(size_t preloaded, size_t opsPerThread, int degree) {
+    cout << "90% lookup / 10% insert, " << preloaded << " preloaded keys, t = " << degree
+         << ", " << thread::hardware_concurrency() << " hardware threads" << endl;
+
+    for (int numThreads : {1, 4, 16, 64}) {
+        LockedBTree locked(degree);
+        OLCBTree<uint64_t, uint64_t> olc(degree);
+        for (size_t i = 0; i < preloaded; i++) {
+            locked.insert(mixKey(i), i);
+            olc.insert(mixKey(i), i);
+        }
+
+        double lockedOps = mixedThroughput(locked, preloaded, numThreads, opsPerThread);
+        double olcOps = mixedThroughput(olc, preloaded, numThreads, opsPerThread);
+        cout << "  " << numThreads << " threads: global mutex " << lockedOps << " Mops/s, OLC "
+             << olcOps << " Mops/s" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    OLCBTree<int, int> tree(2);
+
+    // A few threads inserting disjoint ranges into the same tree
+    vector<thread> writers;
+    for (int w = 0; w < 4; w++) {
+        writers.emplace_back([&tree, w]() {
+            for (int i = 0; i < 1000; i++) {
+                tree.insert(i * 4 + w, i);
+            }
+        });
+    }
+    for (thread& writer : writers) {
+        writer.join();
+    }
+
+    int missing = 0;
+    for (int key = 0; key < 4000; key++) {
+        if (!tree.search(key)) {
+            missing++;
+        }
+    }
+    cout << "4000 concurrent inserts, missing after join: " << missing << endl;
+
+    int value = 0;
+    if (tree.search(2001, &value)) {
+        cout << "2001 found with value " << value << endl;
+    }
+
+    // Pass "full" for a bigger tree and longer runs
+    bool full = argc > 1 && string(argv[1]) == "full";
+    if (full) {
+        benchmarkMixedWorkload(10'000'000, 2'000'000, 16);
+    } else {
+        benchmarkMixedWorkload(1'000'000, 200'000, 16);
+    }
+
+    return 0;
+}
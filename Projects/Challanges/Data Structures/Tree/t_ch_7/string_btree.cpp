@@ -0,0 +1,537 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "btree.h"
+
+/*
+ * String keys in B-Tree nodes
+ *
+ * BTree<string, V> stores a whole std::string per key slot: 32 bytes of object, plus a heap
+ * block for anything longer than the small-string buffer. Comparing two keys follows both
+ * pointers, and the rank inside a node does that log2(2t) times per level.
+ *
+ * Keys in a B-Tree node are sorted and close together, so they usually start with the same
+ * bytes - URLs share "https://host/", file paths share their directories. StringBTree stores
+ * each node's keys like this:
+ *
+ *   prefix   "https://example.com/users/"   stored once per node
+ *   heads    [ "1042/pos" | "1043/lik" | ... ]   first 8 bytes after the prefix, as big-endian integers
+ *   slots    [ {offset, length} ... ]           where each suffix lives in the node's byte heap
+ *   bytes    "1042/posts1043/likes..."          the suffixes, back to back
+ *
+ * Reading the first 8 bytes big-endian (zero padded) keeps the order: if a < b as strings then
+ * head(a) <= head(b) as integers. So the rank inside a node is an integer rank over 'heads'
+ * (the SIMD KeyRank<uint64_t> from key_rank.h), and only keys whose head is exactly equal to
+ * the probe's head - usually none or one - are compared byte by byte.
+ *
+ * A key that does not start with the node's prefix needs no comparison against the keys at
+ * all: it is smaller than every key in the node or larger than all of them. When such a key is
+ * inserted into the node, the prefix is cut back to what the new key shares with it. A split
+ * goes the other way: each half recomputes its prefix, which can only get longer.
+ *
+ * Because keys shrink by different amounts, a node is full when its bytes reach a budget, not
+ * when it has 2t - 1 keys. Splits cut the node at the middle byte, not the middle key. The
+ * more the keys share, the more of them fit in a node, and that is where the fanout comes from.
+ */
+
+using namespace std;
+
+/**
+ * @brief B-Tree with string keys, stored prefix-compressed inside every node.
+ *
+ * Same algorithms as BTree (preemptive split on the way down, keys equal to a separator go
+ * right), with a node format specialised for strings. A node has no fixed number of keys. It
+ * is split on the way down once the next key might push it past maxNodeBytes. The separator
+ * that moves up can take the parent past the budget by one key; that parent is split the next
+ * time an insert passes through it.
+ *
+ * A node's arrays (heads, slots, bytes, values, children) are separate vectors, so a node is
+ * several heap blocks rather than one contiguous page.
+ *
+ * @tparam V Value type.
+ */
+template <typename V>
+class StringBTree {
+private:
+    /**
+     * @brief Where a key's suffix (the part after the node's prefix) lives in the node's byte heap.
+     */
+    struct KeySlot {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    /**
+     * @brief StringNode struct
+     *
+     * - prefix: bytes every key in this node starts with, stored once
+     * - heads: first 8 bytes of every suffix as a big-endian integer, what the rank looks at
+     * - slots / bytes: the full suffixes, only read when two heads are equal
+     */
+    struct StringNode {
+        bool isLeaf;
+        int numKeys;
+        string prefix;
+        vector<uint64_t> heads;         // numKeys
+        vector<KeySlot> slots;          // numKeys
+        vector<char> bytes;
+        vector<V> values;               // numKeys
+        vector<StringNode*> children;   // numKeys + 1, empty in a leaf
+
+        StringNode(bool leaf) : isLeaf(leaf), numKeys(0) {}
+    };
+
+    // Bytes a key costs a node besides its suffix
+    static constexpr size_t KeyOverhead = sizeof(uint64_t) + sizeof(KeySlot) + sizeof(V) + sizeof(StringNode*);
+
+    StringNode* root;
+    size_t maxNodeBytes;
+
+    /**
+     * @brief First 8 bytes of 's' as a big-endian integer, zero padded.
+     */
+    static uint64_t headOf(string_view s) {
+        uint64_t head = 0;
+        size_t n = min<size_t>(s.size(), 8);
+        for (size_t i = 0; i < n; i++) {
+            head |= uint64_t(static_cast<unsigned char>(s[i])) << (56 - 8 * i);
+        }
+        return head;
+    }
+
+    static string_view suffixAt(const StringNode* node, int i) {
+        return string_view(node->bytes.data() + node->slots[i].offset, node->slots[i].length);
+    }
+
+    static string keyAt(const StringNode* node, int i) {
+        string key = node->prefix;
+        key.append(suffixAt(node, i));
+        return key;
+    }
+
+    /**
+     * @brief Bytes 'node' takes up: its prefix, its suffixes and the fixed part of every key.
+     */
+    static size_t nodeBytes(const StringNode* node) {
+        return node->prefix.size() + node->bytes.size() + node->numKeys * KeyOverhead;
+    }
+
+    /**
+     * @brief True if inserting 'key' below 'node' could take it past the byte budget.
+     *
+     * The key is charged in full, as if it shared nothing with the prefix. A node needs 3 keys to
+     * split into two non-empty halves, so fewer keys never count as full.
+     */
+    bool isFull(const StringNode* node, string_view key) const {
+        return node->numKeys >= 3 && nodeBytes(node) + key.size() + KeyOverhead > maxNodeBytes;
+    }
+
+    static size_t commonPrefixLength(string_view a, string_view b) {
+        size_t n = min(a.size(), b.size());
+        size_t i = 0;
+        while (i < n && a[i] == b[i]) {
+            i++;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Number of keys in 'node' that are < key (Upper = false) or <= key (Upper = true).
+     *
+     * The integer rank over 'heads' narrows the answer down to the keys whose head equals the
+     * probe's; those few are then compared on their full suffix.
+     */
+    template <bool Upper>
+    static int rank(const StringNode* node, string_view key) {
+        if (!key.starts_with(node->prefix)) {
+            // Every key in the node starts with the prefix, so they are all on one side of 'key'
+            return key < string_view(node->prefix) ? 0 : node->numKeys;
+        }
+        string_view suffix = key.substr(node->prefix.size());
+        uint64_t head = headOf(suffix);
+
+        int lo = KeyRank<uint64_t>::lower(node->heads.data(), node->numKeys, head);
+        int hi = lo;
+        while (hi < node->numKeys && node->heads[hi] == head) {
+            hi++;
+        }
+        // Same head: compare the full suffixes (binary search, the range is sorted too)
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            int cmp = suffixAt(node, mid).compare(suffix);
+            if (cmp < 0 || (Upper && cmp == 0)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Appends 'suffix' to the node's byte heap and describes it in slot 'i'.
+     */
+    static void storeSuffix(StringNode* node, int i, string_view suffix) {
+        node->slots[i] = {static_cast<uint32_t>(node->bytes.size()), static_cast<uint32_t>(suffix.size())};
+        node->bytes.insert(node->bytes.end(), suffix.begin(), suffix.end());
+        node->heads[i] = headOf(suffix);
+    }
+
+    /**
+     * @brief Cuts the node's prefix down to its first 'length' bytes, moving the cut-off bytes into every suffix.
+     */
+    static void shrinkPrefix(StringNode* node, size_t length) {
+        string_view moved = string_view(node->prefix).substr(length);
+        vector<char> oldBytes;
+        oldBytes.swap(node->bytes);
+        node->bytes.reserve(oldBytes.size() + node->numKeys * moved.size());
+
+        for (int i = 0; i < node->numKeys; i++) {
+            KeySlot old = node->slots[i];
+            node->slots[i] = {static_cast<uint32_t>(node->bytes.size()),
+                              static_cast<uint32_t>(moved.size() + old.length)};
+            node->bytes.insert(node->bytes.end(), moved.begin(), moved.end());
+            node->bytes.insert(node->bytes.end(), oldBytes.begin() + old.offset,
+                               oldBytes.begin() + old.offset + old.length);
+            node->heads[i] = headOf(suffixAt(node, i));
+        }
+        node->prefix.resize(length);
+    }
+
+    /**
+     * @brief Rewrites 'node' to hold exactly keys[first, first + count), with the longest prefix they share.
+     */
+    static void encodeKeys(StringNode* node, const vector<string>& keys, int first, int count) {
+        node->numKeys = count;
+        node->heads.resize(count);
+        node->slots.resize(count);
+        node->bytes.clear();
+        node->prefix.clear();
+        if (count == 0) {
+            return;
+        }
+        // The keys are sorted, so what the first and last share, all of them share
+        node->prefix = keys[first].substr(0, commonPrefixLength(keys[first], keys[first + count - 1]));
+        for (int i = 0; i < count; i++) {
+            storeSuffix(node, i, string_view(keys[first + i]).substr(node->prefix.size()));
+        }
+    }
+
+    /**
+     * @brief Puts (key, value) at slot 'pos' of 'node', shifting the slots after it.
+     */
+    void insertAt(StringNode* node, int pos, string_view key, const V& value) {
+        if (node->numKeys == 0) {
+            // A node's first key can be its own prefix
+            node->prefix.assign(key);
+        } else if (!key.starts_with(node->prefix)) {
+            shrinkPrefix(node, commonPrefixLength(node->prefix, key));
+        }
+
+        node->heads.insert(node->heads.begin() + pos, 0);
+        node->slots.insert(node->slots.begin() + pos, KeySlot{});
+        node->values.insert(node->values.begin() + pos, value);
+        storeSuffix(node, pos, key.substr(node->prefix.size()));
+        node->numKeys++;
+    }
+
+    /**
+     * @brief Index of the key that splits 'node' into two halves of about the same number of bytes.
+     */
+    static int byteMedian(const StringNode* node) {
+        size_t total = node->bytes.size() + node->numKeys * KeyOverhead;
+        size_t before = 0;
+        int mid = 0;
+        while (mid < node->numKeys - 2 && 2 * (before + node->slots[mid].length + KeyOverhead) <= total) {
+            before += node->slots[mid].length + KeyOverhead;
+            mid++;
+        }
+        return max(mid, 1);
+    }
+
+    /**
+     * @brief Splits the full child at 'childIndex' of 'parentNode', same steps as BTree::splitChild.
+     *
+     * The median is picked by bytes rather than by count. Both halves are re-encoded from the
+     * full keys, so each gets the (longer) prefix its own keys share and a byte heap without the
+     * other half's suffixes.
+     */
+    void splitChild(StringNode* parentNode, int childIndex) {
+        StringNode* fullChild = parentNode->children[childIndex];
+        StringNode* newNode = new StringNode(fullChild->isLeaf);
+        int numKeys = fullChild->numKeys;
+        int mid = byteMedian(fullChild);
+
+        vector<string> keys(numKeys);
+        for (int i = 0; i < numKeys; i++) {
+            keys[i] = keyAt(fullChild, i);
+        }
+
+        newNode->values.assign(make_move_iterator(fullChild->values.begin() + mid + 1),
+                               make_move_iterator(fullChild->values.end()));
+        if (!fullChild->isLeaf) {
+            newNode->children.assign(fullChild->children.begin() + mid + 1, fullChild->children.end());
+            fullChild->children.resize(mid + 1);
+        }
+        encodeKeys(newNode, keys, mid + 1, numKeys - mid - 1);
+
+        V median = std::move(fullChild->values[mid]);
+        fullChild->values.resize(mid);
+        encodeKeys(fullChild, keys, 0, mid);
+
+        parentNode->children.insert(parentNode->children.begin() + childIndex + 1, newNode);
+        insertAt(parentNode, childIndex, keys[mid], median);
+    }
+
+    void insertNonFull(StringNode* node, string_view key, const V& value) {
+        while (!node->isLeaf) {
+            int childIndex = rank<true>(node, key);
+            if (isFull(node->children[childIndex], key)) {
+                splitChild(node, childIndex);
+                if (rank<true>(node, key) > childIndex) {
+                    childIndex++;
+                }
+            }
+            node = node->children[childIndex];
+        }
+        insertAt(node, rank<true>(node, key), key, value);
+    }
+
+    void printInOrderNode(const StringNode* node) const {
+        for (int i = 0; i < node->numKeys; i++) {
+            if (!node->isLeaf) {
+                printInOrderNode(node->children[i]);
+            }
+            cout << keyAt(node, i) << " ";
+        }
+        if (!node->isLeaf) {
+            printInOrderNode(node->children[node->numKeys]);
+        }
+    }
+
+    void clearSubtree(StringNode* node) {
+        if (node == nullptr) {
+            return;
+        }
+        if (!node->isLeaf) {
+            for (int i = 0; i <= node->numKeys; i++) {
+                clearSubtree(node->children[i]);
+            }
+        }
+        delete node;
+    }
+
+    void countBytes(const StringNode* node, size_t& keyBytes, size_t& numKeys, size_t& numNodes) const {
+        keyBytes += node->prefix.size() + node->bytes.size();
+        numKeys += node->numKeys;
+        numNodes++;
+        if (!node->isLeaf) {
+            for (int i = 0; i <= node->numKeys; i++) {
+                countBytes(node->children[i], keyBytes, numKeys, numNodes);
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor for StringBTree.
+     *
+     * @param maxNodeBytes Byte budget of a node (see nodeBytes) past which it is split.
+     */
+    explicit StringBTree(size_t maxNodeBytes = 4096) : root(nullptr), maxNodeBytes(maxNodeBytes) {}
+
+    StringBTree(const StringBTree&) = delete;
+    StringBTree& operator=(const StringBTree&) = delete;
+
+    ~StringBTree() {
+        clearSubtree(root);
+    }
+
+    /**
+     * @brief Insert a key-value pair into the B-Tree.
+     */
+    void insert(string_view key, const V& value) {
+        if (root == nullptr) {
+            root = new StringNode(true);
+        }
+        if (isFull(root, key)) {
+            StringNode* newRoot = new StringNode(false);
+            newRoot->children.push_back(root);
+            splitChild(newRoot, 0);
+            root = newRoot;
+        }
+        insertNonFull(root, key, value);
+    }
+
+    /**
+     * @brief Look up the value stored for a key.
+     *
+     * @return V* Pointer to the value, or nullptr if the key is not in the tree.
+     */
+    V* find(string_view key) {
+        StringNode* node = root;
+        while (node != nullptr) {
+            int i = rank<false>(node, key);
+            if (i < node->numKeys && node->prefix.size() + node->slots[i].length == key.size() &&
+                key.starts_with(node->prefix) && suffixAt(node, i) == key.substr(node->prefix.size())) {
+                return &node->values[i];
+            }
+            node = node->isLeaf ? nullptr : node->children[i];
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Search for a key in the B-Tree.
+     */
+    bool search(string_view key) {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Print the B-Tree keys in sorted (in-order) order.
+     */
+    void printInOrder() const {
+        if (root != nullptr) {
+            printInOrderNode(root);
+        }
+        cout << endl;
+    }
+
+    /**
+     * @brief Average bytes of key data stored per key (prefixes + suffix heaps).
+     */
+    double keyBytesPerKey() const {
+        size_t keyBytes = 0;
+        size_t numKeys = 0;
+        size_t numNodes = 0;
+        if (root != nullptr) {
+            countBytes(root, keyBytes, numKeys, numNodes);
+        }
+        return numKeys == 0 ? 0.0 : static_cast<double>(keyBytes) / numKeys;
+    }
+
+    /**
+     * @brief Average number of keys per node, i.e. the fanout minus one.
+     */
+    double keysPerNode() const {
+        size_t keyBytes = 0;
+        size_t numKeys = 0;
+        size_t numNodes = 0;
+        if (root != nullptr) {
+            countBytes(root, keyBytes, numKeys, numNodes);
+        }
+        return numNodes == 0 ? 0.0 : static_cast<double>(numKeys) / numNodes;
+    }
+};
+
+// --- Benchmark ---
+
+static double nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Keys that share long prefixes, like a crawler's URL index or a file system's path index.
+ */
+static vector<string> makeKeys(const string& kind, size_t numKeys) {
+    mt19937_64 rng(5);
+    vector<string> keys(numKeys);
+    for (size_t i = 0; i < numKeys; i++) {
+        uint64_t a = rng() % 10'000;
+        uint64_t b = rng() % 1'000'000;
+        if (kind == "url") {
+            keys[i] = "https://www.example.com/users/" + to_string(a) + "/posts/" + to_string(b) + "?ref=feed";
+        } else {
+            keys[i] = "/home/build/projects/service/src/module_" + to_string(a % 500) + "/component_" +
+                      to_string(a) + "/file_" + to_string(b) + ".cpp";
+        }
+    }
+    return keys;
+}
+
+/**
+ * @brief Insert and lookup times of BTree<string, V> vs StringBTree<V> on one kind of keys.
+ *
+ * StringBTree gets the bytes a full BTree node of degree 'degree' has for its string objects,
+ * values and children, and has to fit the key bytes in them too.
+ */
+void benchmarkStringKeys(const string& kind, size_t numKeys, int degree) {
+    vector<string> keys = makeKeys(kind, numKeys);
+    size_t totalLength = 0;
+    for (const string& key : keys) {
+        totalLength += key.size();
+    }
+    cout << numKeys << " " << kind << " keys (" << totalLength / numKeys << " bytes on average), t = "
+         << degree << endl;
+
+    vector<string> probes(1'000'000);
+    mt19937_64 rng(9);
+    for (string& probe : probes) {
+        probe = keys[rng() % numKeys];
+    }
+
+    BTree<string, uint64_t> plain(degree);
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        plain.insert(keys[i], i);
+    }
+    double plainInsert = nanosSince(start) / numKeys;
+
+    size_t found = 0;
+    start = chrono::steady_clock::now();
+    for (const string& probe : probes) {
+        found += plain.search(probe);
+    }
+    double plainLookup = nanosSince(start) / probes.size();
+
+    size_t nodeBytes = (2 * degree - 1) * (sizeof(string) + sizeof(uint64_t)) + 2 * degree * sizeof(void*);
+    StringBTree<uint64_t> compressed(nodeBytes);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < numKeys; i++) {
+        compressed.insert(keys[i], i);
+    }
+    double compressedInsert = nanosSince(start) / numKeys;
+
+    start = chrono::steady_clock::now();
+    for (const string& probe : probes) {
+        found += compressed.search(probe);
+    }
+    double compressedLookup = nanosSince(start) / probes.size();
+
+    cout << "  BTree<string>: insert " << plainInsert << " ns, lookup " << plainLookup << " ns, "
+         << sizeof(string) << " + " << totalLength / numKeys << " bytes per key, at most "
+         << 2 * degree - 1 << " keys per node" << endl;
+    cout << "  StringBTree:   insert " << compressedInsert << " ns, lookup " << compressedLookup << " ns, "
+         << sizeof(uint64_t) + 2 * sizeof(uint32_t) << " + " << compressed.keyBytesPerKey() << " bytes per key, "
+         << compressed.keysPerNode() << " keys per node in " << nodeBytes << " bytes"
+         << (found == 2 * probes.size() ? "" : " (missing keys)") << endl;
+}
+
+int main(int argc, char* argv[]) {
+    // A small budget so that these few keys already split
+    StringBTree<int> tree(128);
+    for (string key : {"apple", "applesauce", "application", "apply", "banana", "band", "bandana", "app"}) {
+        tree.insert(key, static_cast<int>(key.size()));
+    }
+    tree.printInOrder();
+
+    if (int* value = tree.find("bandana")) {
+        cout << "bandana found with value " << *value << endl;
+    }
+    if (!tree.search("appl")) {
+        cout << "appl not found" << endl;
+    }
+
+    // Pass "full" for trees that do not fit in cache
+    bool full = argc > 1 && string(argv[1]) == "full";
+    size_t numKeys = full ? 10'000'000 : 1'000'000;
+    benchmarkStringKeys("url", numKeys, 32);
+    benchmarkStringKeys("path", numKeys, 32);
+
+    return 0;
+}
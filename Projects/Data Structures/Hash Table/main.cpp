@@ -1,5 +1,10 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <chrono>
+#include <random>
 
 using namespace std;
 
@@ -7,70 +12,115 @@ class Node {
 public:
     string key;
     int value;
+    size_t hash;  // full hashFunction(key), cached so resize and lookups never re-hash the string
     Node* next;
 
-    Node(const string& key, int value) {
+    Node(const string& key, int value, size_t hash) {
         this->key = key;
         this->value = value;
+        this->hash = hash;
         this->next = nullptr;
     }
 };
 
+/**
+ * HashTable of string keys and int values, chained with singly linked Nodes.
+ *
+ * The bucket array grows: it starts at 8 buckets and doubles whenever the average chain length
+ * would pass maxLoadFactor, so chains stay O(1) long no matter how many keys are stored.
+ * The bucket count is always a power of two, which turns "hash % size" into a mask; that is only
+ * safe because the string hash goes through a mixer first (see hashFunction).
+ *
+ * insert() puts the new node at the head of its chain and does not look for an existing copy of
+ * the key, so it is O(1). A key inserted twice shadows its older entry (search() finds the
+ * newest) until remove() takes the newest one out.
+ *
+ * search(), remove() and containsKey() take string_view, so callers holding a slice of some
+ * buffer (or a string literal) look keys up without building a temporary string. Each Node keeps
+ * its full hash: resize() relinks by it, and a chain walk compares it before touching the key.
+ */
 class HashTable {
 private:
-    static const int SIZE = 7;
-    Node* dataMap[SIZE];
+    static const int INITIAL_SIZE = 8;
+    vector<Node*> dataMap;
     int numElements;
+    float maxLoadFactor;
 
-public:
-    HashTable() {
-        for (int i = 0; i < SIZE; ++i) {
-            dataMap[i] = nullptr;
+    // Doubles the bucket array and relinks every node into its new chain (no node is reallocated)
+    void resize() {
+        vector<Node*> newMap(dataMap.size() * 2, nullptr);
+        size_t mask = newMap.size() - 1;
+        for (Node* head : dataMap) {
+            while (head != nullptr) {
+                Node* nextNode = head->next;
+                size_t index = head->hash & mask;
+                head->next = newMap[index];
+                newMap[index] = head;
+                head = nextNode;
+            }
         }
+        dataMap.swap(newMap);
+    }
+
+public:
+    explicit HashTable(float maxLoadFactor = 1.0f) : dataMap(INITIAL_SIZE, nullptr) {
         numElements = 0;
+        this->maxLoadFactor = maxLoadFactor;
     }
     ~HashTable() {
-        for (int i = 0; i < SIZE; i++) {
-            Node* current = dataMap[i];
-            while (current != nullptr) {
-                Node* nextNode = current->next;
-                delete current;
-                current = nextNode;
-            }
+        clear();
+    }
+
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
+    // FNV-1a over the bytes, finished with the splitmix64 mixer so that every bit of the result
+    // depends on every input byte and the low bits can be used as the bucket index directly
+    static size_t hashFunction(string_view key) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 1099511628211ULL;
         }
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        return hash ^ (hash >> 31);
     }
 
-    int hashFunction(const string& key) {
-        int hash = 0;
-        for (unsigned char i : key) {
-            int asciiValue = int(i);
-            hash = (hash + asciiValue * 23) % SIZE;
+    size_t bucketIndex(size_t hash) const {
+        return hash & (dataMap.size() - 1);
+    }
+
+    // Returns the newest node holding key, or nullptr
+    Node* findNode(string_view key) const {
+        size_t hash = hashFunction(key);
+        for (Node* temp = dataMap[bucketIndex(hash)]; temp != nullptr; temp = temp->next) {
+            if (temp->hash == hash && temp->key == key) {
+                return temp;
+            }
         }
-        return hash;
+        return nullptr;
     }
 
     void insert(const string& key, int value) {
-        int index = hashFunction(key);
-        Node* newNode = new Node(key, value);
-        if (dataMap[index] == nullptr) {
-            dataMap[index] = newNode;
-        } else {
-            Node* temp = dataMap[index];
-            while (temp->next != nullptr) {
-                temp = temp->next;
-            }
-            temp->next = newNode;
+        if (numElements + 1 > maxLoadFactor * dataMap.size()) {
+            resize();
         }
+        size_t hash = hashFunction(key);
+        size_t index = bucketIndex(hash);
+        Node* newNode = new Node(key, value, hash);
+        newNode->next = dataMap[index];
+        dataMap[index] = newNode;
         numElements++;
     }
 
-    bool remove(const string& key) {
-        int index = hashFunction(key);
+    bool remove(string_view key) {
+        size_t hash = hashFunction(key);
+        size_t index = bucketIndex(hash);
         Node* current = dataMap[index];
         Node* previous = nullptr;
 
         while (current != nullptr) {
-            if (current->key == key) {
+            if (current->hash == hash && current->key == key) {
                 if (previous == nullptr) {
                     dataMap[index] = current->next;
                 } else {
@@ -86,20 +136,13 @@ public:
         return false;
     }
 
-    int search(const string& key) {
-        int index = hashFunction(key);
-        Node* temp = dataMap[index];
-        while (temp != nullptr) {
-            if (temp->key == key) {
-                return temp->value;
-            }
-            temp = temp->next;
-        }
-        return -1;
+    int search(string_view key) const {
+        Node* node = findNode(key);
+        return node != nullptr ? node->value : -1;
     }
 
     void printTable() {
-        for (int i = 0; i < SIZE; i++) {
+        for (size_t i = 0; i < dataMap.size(); i++) {
             cout << i << ":";
             Node* temp = dataMap[i];
             while (temp != nullptr) {
@@ -112,8 +155,8 @@ public:
 
     vector<string> keys() {
         vector<string> allKeys;
-        for (int i = 0; i < SIZE; i++) {
-            Node* temp = dataMap[i];
+        allKeys.reserve(numElements);
+        for (Node* temp : dataMap) {
             while (temp != nullptr) {
                 allKeys.push_back(temp->key);
                 temp = temp->next;
@@ -122,40 +165,59 @@ public:
         return allKeys;
     }
 
-    bool containsKey(const string& key) {
-        int index = hashFunction(key);
-        Node* temp = dataMap[index];
-        while (temp != nullptr) {
-            if (temp->key == key) {
-                return true;
-            }
-            temp = temp->next;
-        }
-        return false;
+    bool containsKey(string_view key) const {
+        return findNode(key) != nullptr;
     }
 
     int getSize() {
         return numElements;
     }
 
+    // Frees every node but keeps the grown bucket array
     void clear() {
-        for (int i = 0; i < SIZE; i++) {
-            Node* current = dataMap[i];
+        for (Node*& head : dataMap) {
+            Node* current = head;
             while (current != nullptr) {
                 Node* nextNode = current->next;
                 delete current;
                 current = nextNode;
             }
-            dataMap[i] = nullptr;
+            head = nullptr;
         }
         numElements = 0;
     }
 
     float loadFactor() {
-        return static_cast<float>(numElements) / SIZE;
+        return static_cast<float>(numElements) / dataMap.size();
     }
 };
 
+static double nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+// Inserts n keys, then times 1M lookups of random present keys
+void benchmarkLookups(int n) {
+    HashTable table;
+    for (int i = 0; i < n; i++) {
+        table.insert("key" + to_string(i), i);
+    }
+
+    mt19937 rng(21);
+    vector<string> probes(1'000'000);
+    for (string& probe : probes) {
+        probe = "key" + to_string(rng() % n);
+    }
+
+    long long sum = 0;
+    auto start = chrono::steady_clock::now();
+    for (const string& probe : probes) {
+        sum += table.search(probe);
+    }
+    cout << "  " << n << " keys: " << nanosSince(start) / probes.size() << " ns per lookup (load "
+         << table.loadFactor() << ")" << (sum < 0 ? " " : "") << endl;
+}
+
 int main() {
     HashTable hashTable;
 
@@ -194,5 +256,10 @@ int main() {
     hashTable.printTable();
     cout << "Current size of hash table: " << hashTable.getSize() << endl;
 
+    cout << "\nLookup cost as the table grows:" << endl;
+    for (int n : {1'000, 10'000, 100'000, 1'000'000, 10'000'000}) {
+        benchmarkLookups(n);
+    }
+
     return 0;
 }